@@ -15,7 +15,9 @@ source_files = [
     "src/pgm_devroye.c",
     "src/pgm_common.c",
     "src/pgm_saddle.c",
+    "src/pgm_tilted.c",
     "src/pgm_density.c",
+    "src/pgm_threadpool.c",
 ]
 
 
@@ -25,8 +27,10 @@ if os.getenv("BUILD_WITH_COVERAGE", None):
 
 if platform.system() == 'Windows':
     compile_args = ['/O2']
+    link_args = []
 else:
-    compile_args = ['-O2', '-std=c99']
+    compile_args = ['-O2', '-std=c99', '-pthread']
+    link_args = ['-pthread']
 
 # https://numpy.org/devdocs/reference/random/examples/cython/setup.py.html
 include_path = np.get_include()
@@ -43,6 +47,7 @@ extensions = [
         libraries=['npyrandom', 'npymath'],
         define_macros=macros,
         extra_compile_args=compile_args,
+        extra_link_args=link_args,
     ),
 ]
 
@@ -16,7 +16,7 @@
  *
  * gcc examples/c_polyagamma.c src/*.c -I./include -I$(python -c "import numpy; print(numpy.get_include())") \
  *  -I/usr/include/python3.9 -L$(python -c "import numpy; print(numpy.get_include())")/../../random/lib \
- *  -lm -lnpyrandom -O2 -march=native -std=c99
+ *  -lm -lnpyrandom -pthread -O2 -march=native -std=c99
  */
 #include "../include/pgm_random.h"
 #include <stdlib.h>
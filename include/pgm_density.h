@@ -1,6 +1,8 @@
 #ifndef PGM_DENSITY_H
 #define PGM_DENSITY_H
 
+#include <stddef.h>
+
 double
 pgm_polyagamma_pdf(double x, double h, double z);
 
@@ -13,4 +15,42 @@ pgm_polyagamma_logpdf(double x, double h, double z);
 double
 pgm_polyagamma_logcdf(double x, double h, double z);
 
+typedef double (*pgm_dist_func_t)(double x, double h, double z);
+
+/*
+ * Evaluate `func` (one of the four functions above) at the triplets
+ * (x[i], h[i], z[i]) and store the results in `out`.
+ *
+ * x, h, z and out must be at least `n` in length. The evaluation is split
+ * across the library's shared worker pool (see pgm_threadpool.h).
+ */
+void
+pgm_polyagamma_dist_fill(pgm_dist_func_t func, const double* x, const double* h,
+                         const double* z, size_t n, double* out);
+
+/*
+ * Compute the implicit reparameterisation gradients of the samples x[i] of
+ * PG(h, z) with respect to z and h, i.e. dx/dz = -(dF/dz) / f and
+ * dx/dh = -(dF/dh) / f, where F and f are the CDF and density of PG(h, z)
+ * evaluated at x[i]. The partial derivatives of F are computed from the same
+ * series as `pgm_polyagamma_cdf`, so the accuracy of the gradients follows
+ * that of the CDF.
+ *
+ * x, dz and dh must be at least `n` in length. Either of dz and dh can be NULL
+ * if the corresponding gradient is not needed. Coefficients of the series that
+ * only depend on h are computed once and reused for every element, and the
+ * evaluation is split across the library's shared worker pool.
+ */
+void
+pgm_polyagamma_implicit_grad(const double* x, double h, double z, size_t n,
+                             double* dz, double* dh);
+
+/*
+ * Same as `pgm_polyagamma_implicit_grad`, but with arrays h and z of at least
+ * `n` elements. Coefficients are reused across runs of equal values of h.
+ */
+void
+pgm_polyagamma_implicit_grad2(const double* x, const double* h, const double* z,
+                              size_t n, double* dz, double* dh);
+
 #endif
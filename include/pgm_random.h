@@ -12,6 +12,43 @@
 
 typedef enum {GAMMA, DEVROYE, ALTERNATE, SADDLE, HYBRID} sampler_t;
 
+/*
+ * Iteration limits of the bounded-latency sampling functions.
+ *
+ *  max_iter : size_t
+ *      The maximum number of proposals drawn to generate one accept/reject
+ *      variate. A sample of the SADDLE method is a single such variate, while
+ *      the DEVROYE and ALTERNATE methods add up about h and h / 4 of them
+ *      respectively. A value of 0 means no cap.
+ *  max_inner : size_t
+ *      The maximum number of series terms evaluated when deciding whether to
+ *      accept a proposal, and of draws made by the rejection loops that
+ *      sample a proposal from a truncated distribution. Such loops accept
+ *      with a high probability, so this cap is meant to be large and is
+ *      rarely reached. A value of 0 means no cap.
+ *  fallbacks : size_t
+ *      Incremented for every sample that reached a cap. It is never reset by
+ *      the sampling functions.
+ *
+ * When a cap is reached, the sampler gives up on the sample and replaces it
+ * with a draw from a fixed-cost approximation of PG(h, z) (a truncated gamma
+ * convolution whose remainder is replaced by a moment-matched gamma variate).
+ * The number of proposals needed does not depend on the value that is finally
+ * accepted, so the samples follow a mixture of PG(h, z) and this
+ * approximation, up to the rare cases where `max_inner` is reached. The work
+ * spent on a sample is then bounded by the caps, apart from the rejection
+ * loops inside numpy's normal, exponential and gamma generators, which have
+ * acceptance rates close to 1.
+ *
+ * The GAMMA method and the normal approximation used by HYBRID for large
+ * `h` have a fixed cost and never fall back.
+ */
+typedef struct {
+    size_t max_iter;
+    size_t max_inner;
+    size_t fallbacks;
+} pgm_bounds_t;
+
 /*
  * generate a sample from a Polya-Gamma distribution PG(h, z)
  *
@@ -73,4 +110,106 @@ void
 pgm_random_polyagamma_fill2(bitgen_t* bitgen_state, const double* h, const double* z,
                             sampler_t method, size_t n, double* PGM_RESTRICT out);
 
+/*
+ * Bounded-latency versions of `pgm_random_polyagamma_fill` and
+ * `pgm_random_polyagamma_fill2`. See `pgm_bounds_t` for the meaning of
+ * `bounds`. Passing NULL or a `max_iter` of 0 produces the same samples as
+ * the unbounded functions.
+ */
+void
+pgm_random_polyagamma_fill_bounded(bitgen_t* bitgen_state, double h, double z,
+                                   sampler_t method, pgm_bounds_t* bounds,
+                                   size_t n, double* out);
+
+void
+pgm_random_polyagamma_fill2_bounded(bitgen_t* bitgen_state, const double* h,
+                                    const double* z, sampler_t method,
+                                    pgm_bounds_t* bounds, size_t n,
+                                    double* PGM_RESTRICT out);
+
+/*
+ * Generate n samples from a PG(h, z) distribution together with their
+ * implicit reparameterisation gradients dout[i]/dz and dout[i]/dh, which
+ * allow pathwise gradient estimates of expectations over PG(h, z) (e.g. in
+ * variational inference). See `pgm_polyagamma_implicit_grad` in
+ * pgm_density.h for how they are computed.
+ *
+ * out, dz and dh must be at least `n` in length. Either of dz and dh can be
+ * NULL if the corresponding gradient is not needed.
+ */
+void
+pgm_random_polyagamma_fill_grad(bitgen_t* bitgen_state, double h, double z,
+                                sampler_t method, size_t n, double* out,
+                                double* dz, double* dh);
+
+/*
+ * Same as `pgm_random_polyagamma_fill_grad`, but h and z are arrays of at
+ * least `n` elements.
+ */
+void
+pgm_random_polyagamma_fill2_grad(bitgen_t* bitgen_state, const double* h,
+                                 const double* z, sampler_t method, size_t n,
+                                 double* PGM_RESTRICT out, double* PGM_RESTRICT dz,
+                                 double* PGM_RESTRICT dh);
+
+/*
+ * An inverse-CDF table of the PG(h, 0) distribution for a fixed value of h.
+ *
+ * Since the density of PG(h, z) is proportional to exp(-0.5 * z^2 * x) times
+ * the density of PG(h, 0), a sample of PG(h, z) can be obtained by drawing
+ * from PG(h, 0) and accepting the draw with probability exp(-0.5 * z^2 * x).
+ * The acceptance rate is cosh(z / 2)^(-h), so this only needs the table and
+ * a uniform per proposal, without any z-dependent setup. This makes it well
+ * suited to cases where h is fixed while small values of z change between
+ * calls (e.g. Gibbs sampling of logistic models).
+ *
+ * Samples drawn from a table are approximate since the CDF is tabulated on a
+ * finite grid and inverted using linear interpolation.
+ */
+typedef struct pgm_table pgm_table_t;
+
+/*
+ * Build the table of PG(h, 0). Returns NULL if memory allocation fails. The
+ * table can be shared by threads and must be released with
+ * `pgm_polyagamma_table_free`.
+ */
+pgm_table_t*
+pgm_polyagamma_table_new(double h);
+
+void
+pgm_polyagamma_table_free(pgm_table_t* table);
+
+/*
+ * Return the largest |z| that is sampled using the table. Larger values are
+ * sampled using the fallback method passed to the sampling functions. A
+ * negative value means that the CDF of PG(h, 0) could not be tabulated
+ * accurately (which happens for large h), so all values are sampled using the
+ * fallback method.
+ */
+double
+pgm_polyagamma_table_zmax(const pgm_table_t* table);
+
+/*
+ * Generate n samples from PG(h, z) using the table of PG(h, 0) and
+ * exponential tilting, where h is the value the table was built for.
+ *
+ * If |z| is larger than `pgm_polyagamma_table_zmax(table)`, the samples are
+ * drawn using `method` instead. `bounds` has the same meaning as in
+ * `pgm_random_polyagamma_fill_bounded` and can be NULL.
+ */
+void
+pgm_random_polyagamma_tilted_fill(bitgen_t* bitgen_state, const pgm_table_t* table,
+                                  double z, sampler_t method, pgm_bounds_t* bounds,
+                                  size_t n, double* out);
+
+/*
+ * Generate n samples from PG(h, z[i]) using the table of PG(h, 0), where z is
+ * an array of at least `n` elements.
+ */
+void
+pgm_random_polyagamma_tilted_fill2(bitgen_t* bitgen_state, const pgm_table_t* table,
+                                   const double* z, sampler_t method,
+                                   pgm_bounds_t* bounds, size_t n,
+                                   double* PGM_RESTRICT out);
+
 #endif
@@ -0,0 +1,58 @@
+#ifndef PGM_THREADPOOL_H
+#define PGM_THREADPOOL_H
+
+#include <stddef.h>
+
+/*
+ * Configuration of the worker pool shared by all of the library's parallel
+ * code paths.
+ *
+ * The pool is created lazily the first time a parallel path runs with more
+ * than one thread. Its initial configuration is read from the environment:
+ *
+ *  PGM_NUM_THREADS : the number of threads to use, including the calling
+ *      thread. Defaults to 1, meaning that all work runs serially on the
+ *      calling thread. A value of 0 means "one thread per online CPU".
+ *  PGM_CPU_AFFINITY : a comma-separated list of CPU ids and/or ranges
+ *      (e.g. "0-3,8,10") that worker threads are pinned to. Worker `i` is
+ *      pinned to the `i`'th CPU of the list, wrapping around if there are more
+ *      workers than CPUs. The calling thread is never pinned.
+ *
+ * Work is always split into contiguous blocks of the output, one per thread,
+ * so that each output page is first written by the thread that fills it.
+ * Together with CPU pinning this places output pages on the NUMA node of the
+ * thread that computes them under a first-touch memory policy.
+ *
+ * On platforms without POSIX threads all work runs on the calling thread.
+ */
+
+/*
+ * Set the number of threads used by parallel code paths and return the
+ * previous value. A value of 0 selects one thread per online CPU. Running
+ * workers are stopped and restarted lazily with the new size.
+ */
+size_t
+pgm_set_num_threads(size_t n);
+
+/*
+ * Return the number of threads used by parallel code paths.
+ */
+size_t
+pgm_get_num_threads(void);
+
+/*
+ * Pin worker threads to the `n` CPU ids in `cpus`. Passing n = 0 removes any
+ * pinning. Returns 0 on success and -1 if CPU pinning is not supported on
+ * the current platform.
+ */
+int
+pgm_set_cpu_affinity(const int* cpus, size_t n);
+
+/*
+ * Copy up to `n` of the CPU ids that workers are pinned to into `cpus` and
+ * return the total number of ids in the current affinity list.
+ */
+size_t
+pgm_get_cpu_affinity(int* cpus, size_t n);
+
+#endif
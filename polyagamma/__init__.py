@@ -1,5 +1,7 @@
 from _polyagamma import (
-    polyagamma as random_polyagamma, polyagamma_pdf, polyagamma_cdf
+    polyagamma as random_polyagamma, polyagamma_pdf, polyagamma_cdf,
+    random_polyagamma_grad,
+    get_num_threads, set_num_threads, threadpool_limits,
 )
 
 __version__ = '1.3.3'
@@ -2,6 +2,10 @@ from ._polyagamma import (
     polyagamma_pdf as polyagamma_pdf,
     polyagamma_cdf as polyagamma_cdf,
     random_polyagamma as random_polyagamma,
+    random_polyagamma_grad as random_polyagamma_grad,
+    get_num_threads as get_num_threads,
+    set_num_threads as set_num_threads,
+    threadpool_limits as threadpool_limits,
 )
 
 __version__ : str
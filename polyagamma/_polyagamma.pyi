@@ -1,5 +1,5 @@
 import sys
-from typing import overload, Union, Tuple
+from typing import overload, Optional, Sequence, Union, Tuple
 
 if sys.version_info >= (3, 8):
     from typing import Literal
@@ -10,7 +10,7 @@ import numpy as np  # type: ignore
 from numpy.typing import _ArrayLikeFloat_co  # type: ignore
 from numpy.random import Generator, BitGenerator, SeedSequence  # type: ignore
 
-_MethodType = Union[Literal["devroye", "alternate", "saddle", "gamma"], None]
+_MethodType = Union[Literal["devroye", "alternate", "saddle", "gamma", "tilted"], None]
 _RNGType = Union[Generator, BitGenerator, SeedSequence, None]
 
 
@@ -22,7 +22,9 @@ def random_polyagamma(
     out: None = ...,
     method: _MethodType = ...,
     disable_checks: bool = ...,
-    random_state: _RNGType = ...
+    random_state: _RNGType = ...,
+    max_iter: Optional[int] = ...,
+    return_fallbacks: Literal[False] = ...,
 ) -> float: ...
 @overload
 def random_polyagamma(size: Tuple[int, ...] = ...) -> np.ndarray: ...
@@ -40,6 +42,39 @@ def random_polyagamma(h: _ArrayLikeFloat_co, z: float) -> np.ndarray: ...
 def random_polyagamma(h: _ArrayLikeFloat_co, disable_checks: bool) -> np.ndarray: ...
 @overload
 def random_polyagamma(h: _ArrayLikeFloat_co, z: _ArrayLikeFloat_co) -> np.ndarray: ...
+@overload
+def random_polyagamma(
+    h: Union[float, _ArrayLikeFloat_co] = ...,
+    z: Union[float, _ArrayLikeFloat_co] = ...,
+    size: Optional[Tuple[int, ...]] = ...,
+    out: Optional[_ArrayLikeFloat_co] = ...,
+    method: _MethodType = ...,
+    disable_checks: bool = ...,
+    random_state: _RNGType = ...,
+    max_iter: Optional[int] = ...,
+    *,
+    return_fallbacks: Literal[True],
+) -> Tuple[Union[float, np.ndarray, None], int]: ...
+
+
+@overload
+def random_polyagamma_grad(
+    h: float = ...,
+    z: float = ...,
+    size: None = ...,
+    method: _MethodType = ...,
+    disable_checks: bool = ...,
+    random_state: _RNGType = ...,
+) -> Tuple[float, float, float]: ...
+@overload
+def random_polyagamma_grad(
+    h: Union[float, _ArrayLikeFloat_co] = ...,
+    z: Union[float, _ArrayLikeFloat_co] = ...,
+    size: Optional[Tuple[int, ...]] = ...,
+    method: _MethodType = ...,
+    disable_checks: bool = ...,
+    random_state: _RNGType = ...,
+) -> Tuple[np.ndarray, np.ndarray, np.ndarray]: ...
 
 
 @overload
@@ -104,3 +139,16 @@ def polyagamma_cdf(
 def polyagamma_cdf(
     x: _ArrayLikeFloat_co, h: _ArrayLikeFloat_co = ..., z: _ArrayLikeFloat_co = ...,
 ) -> np.ndarray: ...
+
+
+def get_num_threads() -> int: ...
+def set_num_threads(num_threads: Optional[int] = ...) -> int: ...
+
+
+class threadpool_limits:
+    def __init__(
+        self, limits: Optional[int] = ..., cpus: Optional[Sequence[int]] = ...,
+    ) -> None: ...
+    def __enter__(self) -> threadpool_limits: ...
+    def __exit__(self, *args: object) -> None: ...
+    def restore_original_limits(self) -> None: ...
@@ -11,7 +11,7 @@ SPDX-License-Identifier: BSD-3-Clause
 from cpython.exc cimport PyErr_Clear
 from cpython.float cimport PyFloat_Check
 from cpython.long cimport PyLong_Check
-from cpython.number cimport PyNumber_Long
+from cpython.number cimport PyNumber_Index, PyNumber_Long
 from cpython.object cimport PyObject_RichCompareBool, Py_LE, Py_LT, Py_NE
 from cpython.pycapsule cimport PyCapsule_GetPointer
 from libc.stdlib cimport free
@@ -22,6 +22,11 @@ from numpy.random import default_rng
 np.import_array()
 
 cdef extern from "pgm_random.h" nogil:
+    ctypedef struct pgm_bounds_t:
+        size_t max_iter
+        size_t max_inner
+        size_t fallbacks
+
     double pgm_random_polyagamma(bitgen_t* bitgen_state, double h,
                                  double z, sampler_t method)
     void pgm_random_polyagamma_fill(bitgen_t* bitgen_state, double h, double z,
@@ -29,6 +34,35 @@ cdef extern from "pgm_random.h" nogil:
     void pgm_random_polyagamma_fill2(bitgen_t* bitgen_state, const double* h,
                                      const double* z, sampler_t method,
                                      size_t n, double* out)
+    void pgm_random_polyagamma_fill_bounded(bitgen_t* bitgen_state, double h,
+                                            double z, sampler_t method,
+                                            pgm_bounds_t* bounds, size_t n,
+                                            double* out)
+    void pgm_random_polyagamma_fill2_bounded(bitgen_t* bitgen_state, const double* h,
+                                             const double* z, sampler_t method,
+                                             pgm_bounds_t* bounds, size_t n,
+                                             double* out)
+    void pgm_random_polyagamma_fill_grad(bitgen_t* bitgen_state, double h, double z,
+                                         sampler_t method, size_t n, double* out,
+                                         double* dz, double* dh)
+    void pgm_random_polyagamma_fill2_grad(bitgen_t* bitgen_state, const double* h,
+                                          const double* z, sampler_t method,
+                                          size_t n, double* out, double* dz,
+                                          double* dh)
+
+    ctypedef struct pgm_table_t:
+        pass
+
+    pgm_table_t* pgm_polyagamma_table_new(double h)
+    void pgm_polyagamma_table_free(pgm_table_t* table)
+    void pgm_random_polyagamma_tilted_fill(bitgen_t* bitgen_state,
+                                           const pgm_table_t* table, double z,
+                                           sampler_t method, pgm_bounds_t* bounds,
+                                           size_t n, double* out)
+    void pgm_random_polyagamma_tilted_fill2(bitgen_t* bitgen_state,
+                                            const pgm_table_t* table, const double* z,
+                                            sampler_t method, pgm_bounds_t* bounds,
+                                            size_t n, double* out)
 
 # Cython-level function definitions to be shared with other cython modules
 cdef inline double random_polyagamma(bitgen_t* bitgen_state, double h, double z,
@@ -59,6 +93,10 @@ cdef dict METHODS = {
 
 cdef const char* BITGEN_NAME = "BitGenerator"
 
+# cap on the series terms used to test a proposal and on the draws made to
+# sample a proposal from a truncated distribution when `max_iter` is set.
+cdef size_t MAX_INNER_ITER = 64
+
 
 cdef inline bint is_a_number(object o):
     return PyFloat_Check(o) or PyLong_Check(o)
@@ -73,7 +111,7 @@ cdef inline int check_method(object h, str method, bint disable_checks) except -
     cdef object o
 
     if method not in METHODS:
-        raise ValueError(f"`method` must be one of {set(METHODS)}")
+        raise ValueError(f"`method` must be one of {set(METHODS) | {'tilted'}}")
 
     if not disable_checks and method == "devroye":
         if is_a_number(h):
@@ -93,9 +131,16 @@ cdef extern from "numpy/ndarrayobject.h":
     int PyArray_IntpConverter(object size, np.PyArray_Dims* shape) except 0
 
 
+cdef inline object with_fallbacks(object samples, pgm_bounds_t* bounds,
+                                 bint return_fallbacks):
+    if return_fallbacks:
+        return samples, bounds.fallbacks
+    return samples
+
+
 cdef inline object _polyagamma_shape_broadcasted(bitgen_t* bitgen, object h, object z,
-                                                 sampler_t stype, np.PyArray_Dims shape,
-                                                 object lock):
+                                                 sampler_t stype, pgm_bounds_t* bounds,
+                                                 np.PyArray_Dims shape, object lock):
     cdef np.flatiter h_iter, z_iter
     cdef double* arr_ptr
     cdef double ch, cz
@@ -110,19 +155,120 @@ cdef inline object _polyagamma_shape_broadcasted(bitgen_t* bitgen, object h, obj
         while np.PyArray_ITER_NOTDONE(h_iter):
             ch = (<double*>np.PyArray_ITER_DATA(h_iter))[0]
             cz = (<double*>np.PyArray_ITER_DATA(z_iter))[0]
-            arr_ptr[0] = pgm_random_polyagamma(bitgen, ch, cz, stype)
+            pgm_random_polyagamma_fill_bounded(bitgen, ch, cz, stype, bounds, 1, arr_ptr)
             np.PyArray_ITER_NEXT(h_iter)
             np.PyArray_ITER_NEXT(z_iter)
             arr_ptr += 1
     return arr
 
+
+cdef class _PolyaGammaTable:
+    """Owner of a PG(h, 0) inverse-CDF table used by the "tilted" method."""
+    cdef pgm_table_t* ptr
+
+    def __cinit__(self, double h):
+        with nogil:
+            self.ptr = pgm_polyagamma_table_new(h)
+        if self.ptr is NULL:
+            raise MemoryError("unable to allocate the table of PG(h, 0)")
+
+    def __dealloc__(self):
+        pgm_polyagamma_table_free(self.ptr)
+
+
+# tables built by the "tilted" method, keyed by the value of h. The oldest
+# table is evicted once the cache is full.
+cdef dict TABLES = {}
+cdef Py_ssize_t MAX_TABLES = 16
+
+
+cdef _PolyaGammaTable get_table(double h):
+    cdef _PolyaGammaTable table = TABLES.get(h)
+
+    if table is None:
+        table = _PolyaGammaTable(h)
+        if len(TABLES) >= MAX_TABLES:
+            del TABLES[next(iter(TABLES))]
+        TABLES[h] = table
+    return table
+
+
+cdef object _polyagamma_tilted(bitgen_t* bitgen, object h, object z, object size,
+                               double[:] out, bint disable_checks,
+                               pgm_bounds_t* bounds, object lock):
+    cdef _PolyaGammaTable table
+    cdef np.ndarray az
+    cdef np.PyArray_Dims shape
+    cdef np.npy_intp arr_len
+    cdef double* arr_ptr
+    cdef double* z_ptr
+    cdef double cz
+    cdef bint has_out = True if out is not None else False
+
+    if not is_a_number(h):
+        raise ValueError("the tilted method requires a scalar `h`")
+    if not disable_checks and PyObject_RichCompareBool(h, 1e-04, Py_LE):
+        raise ValueError("`h` must be positive")
+    # keep a reference so that the table outlives its eviction from the cache.
+    table = get_table(h)
+
+    if is_a_number(z):
+        cz = z
+        if not has_out and size is None:
+            with lock, nogil:
+                pgm_random_polyagamma_tilted_fill(bitgen, table.ptr, cz, HYBRID,
+                                                  bounds, 1, &cz)
+            return cz
+        elif has_out:
+            with lock, nogil:
+                pgm_random_polyagamma_tilted_fill(bitgen, table.ptr, cz, HYBRID,
+                                                  bounds, out.shape[0], &out[0])
+            return None
+        PyArray_IntpConverter(size, &shape)
+        arr = np.PyArray_EMPTY(shape.len, shape.ptr, np.NPY_DOUBLE, 0)
+        free(shape.ptr)
+        arr_len = np.PyArray_SIZE(arr)
+        arr_ptr = <double*>np.PyArray_DATA(arr)
+        with lock, nogil:
+            pgm_random_polyagamma_tilted_fill(bitgen, table.ptr, cz, HYBRID,
+                                              bounds, arr_len, arr_ptr)
+        return arr
+
+    z = np.PyArray_FROM_OT(z, np.NPY_DOUBLE)
+    if size is not None:
+        PyArray_IntpConverter(size, &shape)
+        arr = np.PyArray_EMPTY(shape.len, shape.ptr, np.NPY_DOUBLE, 0)
+        free(shape.ptr)
+        az = as_contiguous_like(z, arr)
+        has_out = False
+    else:
+        az = np.PyArray_FROM_OTF(z, np.NPY_DOUBLE, np.NPY_ARRAY_IN_ARRAY)
+        if has_out and out.shape[0] != np.PyArray_SIZE(az):
+            raise ValueError(
+                "`out` must have the same total size as the broadcasted "
+                "result of `h` and `z`"
+            )
+        elif not has_out:
+            arr = np.PyArray_EMPTY(np.PyArray_NDIM(az), np.PyArray_DIMS(az),
+                                   np.NPY_DOUBLE, 0)
+
+    arr_len = np.PyArray_SIZE(az)
+    arr_ptr = &out[0] if has_out else <double*>np.PyArray_DATA(arr)
+    z_ptr = <double*>np.PyArray_DATA(az)
+    with lock, nogil:
+        pgm_random_polyagamma_tilted_fill2(bitgen, table.ptr, z_ptr, HYBRID, bounds,
+                                           arr_len, arr_ptr)
+    return None if has_out else arr
+
 # intentionally named `polyagamma` instead of `random_polyagamma` in this file
 # to avoid name clashing with the cython function of the same name.
 def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
-               bint disable_checks=False, random_state=None):
+               bint disable_checks=False, random_state=None, max_iter=None,
+               bint return_fallbacks=False):
     """
     random_polyagamma(h=1., z=0., *, size=None, out=None, method=None,
-                      disable_checks=False, random_state=None)
+                      disable_checks=False, random_state=None, max_iter=None,
+                      return_fallbacks=False)
 
     Draw samples from a Polya-Gamma distribution.
 
@@ -164,7 +310,8 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
     method : str or None, optional
         The method to use when sampling. If None (default) then a hybrid
         sampler is used that picks the most efficient method based on the value
-        of `h`. A legal value must be one of {"gamma", "devroye", "alternate", "saddle"}.
+        of `h`. A legal value must be one of {"gamma", "devroye", "alternate",
+        "saddle", "tilted"}.
         - "gamma" method generates a sample using a convolution of gamma random
           variates.
         - "devroye" method generates a sample using an accept-rejection scheme
@@ -175,7 +322,18 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
           distribution's density as an envelope in order to speed up the
           accept-rejection scheme. It is mainly suitable for large values of `h`
           (e.g. h > 20).
+        - "tilted" method draws from a table of the inverse CDF of PG(h, 0)
+          and accepts a draw `x` with probability exp(-z^2 * x / 2). The table
+          is built once per value of `h` and cached, so it suits repeated calls
+          with a fixed `h` and small values of `z` that change between calls
+          (e.g. Gibbs sampling). Values of `z` for which fewer than half of the
+          draws would be accepted are sampled using the hybrid sampler. The
+          samples are approximate, with an error set by the table resolution.
+
+          .. versionadded:: 1.4.0
+
         If the "devroye" method is used, the `h` must be a positive integer.
+        If the "tilted" method is used, the `h` must be a scalar.
     disable_checks : bool, optional
         Whether to check that the `h` parameter contains only positive
         values(s). Disabling may give a performance gain, but may result
@@ -189,11 +347,34 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
         pass in a `SeedSequence` instance.
         Additionally, when passed a `BitGenerator`, it will be wrapped by
         `Generator`. If passed a `Generator`, it will be returned unaltered.
+    max_iter : int or None, optional
+        Enables the bounded-latency mode when set. It caps the number of
+        proposals drawn to generate each accept-reject variate. The series
+        evaluated when testing a proposal and the loops that sample a proposal
+        from a truncated distribution are capped at 64 iterations, far more
+        than they need in practice. A sample whose sampler reaches a cap
+        is replaced by a draw from a fixed-cost approximation of the
+        distribution (a truncated gamma convolution with a moment-matched
+        remainder), so the samples follow a mixture of the exact distribution
+        and this close approximation. If None (default), sampling is exact and
+        has no caps.
+
+        .. versionadded:: 1.4.0
+
+    return_fallbacks : bool, optional
+        Whether to also return the number of samples that were replaced
+        because a cap set by `max_iter` was reached. Defaults to False.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
     out : numpy.ndarray or scalar
         Samples from a Polya-Gamma distribution with parameters `h` & `z`.
+        If `out` is given, None is returned instead.
+    fallbacks : int
+        The number of samples drawn from the approximation due to the caps
+        set by `max_iter`. Only returned if `return_fallbacks` is True.
 
     Notes
     -----
@@ -223,6 +404,9 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
     >>> from polyagamma import random_polyagamma
     # outputs a 5 by 10 array of PG(1, 0) samples.
     >>> out = random_polyagamma(size=(5, 10))
+    # cap the cost of each sample and count how often the cap was reached.
+    >>> out, fallbacks = random_polyagamma(4, 2, size=1000, max_iter=8,
+    ...                                    return_fallbacks=True)
     # broadcasting to generate 5 values from PG(1, 5), PG(2, 5),...,PG(5, 5)
     >>> a = [1, 2, 3, 4, 5]
     >>> random_polyagamma(a, 5)
@@ -249,11 +433,27 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
     cdef bitgen_t* bitgen
     cdef sampler_t stype = HYBRID
     cdef bint has_out = True if out is not None else False
+    cdef pgm_bounds_t bounds
+
+    bounds.max_iter = bounds.max_inner = bounds.fallbacks = 0
+    if max_iter is not None:
+        try:
+            max_iter = PyNumber_Index(max_iter)
+        except TypeError:
+            max_iter = 0
+        if max_iter < 1:
+            raise ValueError("`max_iter` must be a positive integer or None")
+        bounds.max_iter = max_iter
+        bounds.max_inner = MAX_INNER_ITER
 
     bitgenerator = <BitGenerator>(default_rng(random_state)._bit_generator)
     bitgen = <bitgen_t*>PyCapsule_GetPointer(bitgenerator.capsule, BITGEN_NAME)
 
-    if method is not None:
+    if method == "tilted":
+        arr = _polyagamma_tilted(bitgen, h, z, size, out, disable_checks, &bounds,
+                                 bitgenerator.lock)
+        return with_fallbacks(arr, &bounds, return_fallbacks)
+    elif method is not None:
         stype = <sampler_t>check_method(h, method, disable_checks)
 
     if params_are_scalars(h, z):
@@ -262,12 +462,13 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
         ch, cz = h, z
         if not has_out and size is None:
             with bitgenerator.lock, nogil:
-                cz = random_polyagamma(bitgen, ch, cz, stype)
-            return cz
+                pgm_random_polyagamma_fill_bounded(bitgen, ch, cz, stype, &bounds, 1, &cz)
+            return with_fallbacks(cz, &bounds, return_fallbacks)
         elif has_out:
             with bitgenerator.lock, nogil:
-                random_polyagamma_fill(bitgen, ch, cz, stype, out.shape[0], &out[0])
-            return
+                pgm_random_polyagamma_fill_bounded(bitgen, ch, cz, stype, &bounds,
+                                                   out.shape[0], &out[0])
+            return with_fallbacks(None, &bounds, return_fallbacks)
         else:
             PyArray_IntpConverter(size, &shape)
             arr = np.PyArray_EMPTY(shape.len, shape.ptr, np.NPY_DOUBLE, 0)
@@ -275,8 +476,9 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
             arr_len = np.PyArray_SIZE(arr)
             arr_ptr = <double*>np.PyArray_DATA(arr)
             with bitgenerator.lock, nogil:
-                pgm_random_polyagamma_fill(bitgen, ch, cz, stype, arr_len, arr_ptr)
-            return arr
+                pgm_random_polyagamma_fill_bounded(bitgen, ch, cz, stype, &bounds,
+                                                   arr_len, arr_ptr)
+            return with_fallbacks(arr, &bounds, return_fallbacks)
 
     h = np.PyArray_FROM_OT(h, np.NPY_DOUBLE)
     if not disable_checks and any(np.PyArray_Ravel(np.PyArray_FROM_O(h <= zero),
@@ -287,7 +489,9 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
     # handle cases where the user also passes a size argument value
     if size is not None:
         PyArray_IntpConverter(size, &shape)
-        return _polyagamma_shape_broadcasted(bitgen, h, z, stype, shape, bitgenerator.lock)
+        arr = _polyagamma_shape_broadcasted(bitgen, h, z, stype, &bounds, shape,
+                                            bitgenerator.lock)
+        return with_fallbacks(arr, &bounds, return_fallbacks)
 
     elif np.PyArray_NDIM(<np.ndarray>h) == np.PyArray_NDIM(<np.ndarray>z) == 1:
         ah, az = h, z
@@ -296,11 +500,12 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
         elif not has_out:
             out = np.PyArray_EMPTY(1, <np.npy_intp*>ah.shape, np.NPY_DOUBLE, 0)
         with bitgenerator.lock, nogil:
-            random_polyagamma_fill2(bitgen, &ah[0], &az[0], stype, out.shape[0], &out[0])
+            pgm_random_polyagamma_fill2_bounded(bitgen, &ah[0], &az[0], stype, &bounds,
+                                                out.shape[0], &out[0])
         if has_out:
-            return
+            return with_fallbacks(None, &bounds, return_fallbacks)
         else:
-            return out.base
+            return with_fallbacks(out.base, &bounds, return_fallbacks)
 
     else:
         bcast = np.PyArray_MultiIterNew2(h, z)
@@ -319,13 +524,307 @@ def polyagamma(h=1., z=0., *, size=None, double[:] out=None, method=None,
             while bcast.index < bcast.size:
                 ch = (<double*>np.PyArray_MultiIter_DATA(bcast, 0))[0]
                 cz = (<double*>np.PyArray_MultiIter_DATA(bcast, 1))[0]
-                arr_ptr[bcast.index] = pgm_random_polyagamma(bitgen, ch, cz, stype)
+                pgm_random_polyagamma_fill_bounded(bitgen, ch, cz, stype, &bounds, 1,
+                                                   arr_ptr + bcast.index)
                 np.PyArray_MultiIter_NEXT(bcast)
 
         if has_out:
-            return
+            return with_fallbacks(None, &bounds, return_fallbacks)
+        else:
+            return with_fallbacks(arr, &bounds, return_fallbacks)
+
+
+def random_polyagamma_grad(h=1., z=0., *, size=None, method=None,
+                           bint disable_checks=False, random_state=None):
+    """
+    random_polyagamma_grad(h=1., z=0., *, size=None, method=None,
+                           disable_checks=False, random_state=None)
+
+    Draw samples from a Polya-Gamma distribution together with their implicit
+    reparameterisation gradients with respect to `z` and `h`.
+
+    For a sample `x` the gradients are computed as ``dx/dz = -(dF/dz) / f``
+    and ``dx/dh = -(dF/dh) / f``, where ``F`` and ``f`` are the distribution
+    and density functions of PG(h, z) evaluated at `x`. They give pathwise
+    (reparameterisation) estimates of the gradients of expectations over the
+    distribution, e.g. when optimizing a variational objective that has
+    Polya-Gamma auxiliary variables, which have a much lower variance than
+    score-function estimates.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    h : scalar or sequence, optional
+        The shape parameter of the distribution. Must be positive.
+        Defaults to 1.
+    z : scalar or sequence, optional
+        The exponential tilting parameter of the distribution. Defaults to 0.
+    size : int or tuple of ints, optional
+        The number of elements to draw from the distribution. If size is
+        ``None`` (default) then a single value is returned when `h` and `z`
+        are scalars, otherwise the shape of the output is that of the
+        broadcasted `h` and `z`.
+    method : str or None, optional
+        The method to use when sampling. See the documentation of
+        `random_polyagamma` for the legal values, except that "tilted" is
+        not supported. Defaults to the hybrid sampler.
+    disable_checks : bool, optional
+        Whether to check that the `h` parameter contains only positive
+        values(s).
+    random_state : {None, int, array_like[ints], SeedSequence, BitGenerator, Generator}, optional
+        A seed to initialize the random number generator. See the
+        documentation of `random_polyagamma`.
+
+    Returns
+    -------
+    out : numpy.ndarray or scalar
+        Samples from a Polya-Gamma distribution with parameters `h` & `z`.
+    grad_z : numpy.ndarray or scalar
+        The gradients of the samples with respect to `z`.
+    grad_h : numpy.ndarray or scalar
+        The gradients of the samples with respect to `h`.
+
+    Notes
+    -----
+    The partial derivatives of the distribution function are computed from
+    the same infinite series as `polyagamma_cdf`, so their accuracy follows
+    that of the distribution function. Evaluation of the gradients is split
+    across the library's worker pool (see `set_num_threads`).
+
+    Examples
+    --------
+    >>> from polyagamma import random_polyagamma_grad
+    >>> x, grad_z, grad_h = random_polyagamma_grad(2, 1.5, size=1000)
+    # the mean of the gradients estimates the derivative of E[x].
+    >>> grad_z.mean()
+
+    """
+    # define an ``h`` value small enough to be regarded as a zero
+    DEF zero = 1e-04
+
+    cdef np.broadcast bcast
+    cdef np.ndarray arr, ah, az, grad_z, grad_h
+    cdef np.PyArray_Dims shape
+    cdef np.npy_intp arr_len
+    cdef double ch, cz, cx, cgz, cgh
+    cdef double* arr_ptr
+    cdef double* h_ptr
+    cdef double* z_ptr
+    cdef double* gz_ptr
+    cdef double* gh_ptr
+    cdef BitGenerator bitgenerator
+    cdef bitgen_t* bitgen
+    cdef sampler_t stype = HYBRID
+    cdef bint scalars = params_are_scalars(h, z)
+
+    bitgenerator = <BitGenerator>(default_rng(random_state)._bit_generator)
+    bitgen = <bitgen_t*>PyCapsule_GetPointer(bitgenerator.capsule, BITGEN_NAME)
+
+    if method == "tilted":
+        raise ValueError("the tilted method does not support gradients")
+    elif method is not None:
+        stype = <sampler_t>check_method(h, method, disable_checks)
+
+    if scalars:
+        if not disable_checks and PyObject_RichCompareBool(h, zero, Py_LE):
+            raise ValueError("`h` must be positive")
+        ch, cz = h, z
+        if size is None:
+            with bitgenerator.lock, nogil:
+                pgm_random_polyagamma_fill_grad(bitgen, ch, cz, stype, 1, &cx,
+                                                &cgz, &cgh)
+            return cx, cgz, cgh
+        PyArray_IntpConverter(size, &shape)
+        arr = np.PyArray_EMPTY(shape.len, shape.ptr, np.NPY_DOUBLE, 0)
+        free(shape.ptr)
+    else:
+        h = np.PyArray_FROM_OT(h, np.NPY_DOUBLE)
+        if not disable_checks and any(np.PyArray_Ravel(np.PyArray_FROM_O(h <= zero),
+                                                       np.NPY_CORDER)):
+            raise ValueError("values of `h` must be positive")
+        z = np.PyArray_FROM_OT(z, np.NPY_DOUBLE)
+        if size is not None:
+            PyArray_IntpConverter(size, &shape)
+            arr = np.PyArray_EMPTY(shape.len, shape.ptr, np.NPY_DOUBLE, 0)
+            free(shape.ptr)
+        else:
+            bcast = np.PyArray_MultiIterNew2(h, z)
+            arr = np.PyArray_EMPTY(bcast.nd, bcast.dimensions, np.NPY_DOUBLE, 0)
+        ah = as_contiguous_like(h, arr)
+        az = as_contiguous_like(z, arr)
+        h_ptr = <double*>np.PyArray_DATA(ah)
+        z_ptr = <double*>np.PyArray_DATA(az)
+
+    grad_z = np.PyArray_EMPTY(np.PyArray_NDIM(arr), np.PyArray_DIMS(arr), np.NPY_DOUBLE, 0)
+    grad_h = np.PyArray_EMPTY(np.PyArray_NDIM(arr), np.PyArray_DIMS(arr), np.NPY_DOUBLE, 0)
+    arr_len = np.PyArray_SIZE(arr)
+    arr_ptr = <double*>np.PyArray_DATA(arr)
+    gz_ptr = <double*>np.PyArray_DATA(grad_z)
+    gh_ptr = <double*>np.PyArray_DATA(grad_h)
+
+    with bitgenerator.lock, nogil:
+        if scalars:
+            pgm_random_polyagamma_fill_grad(bitgen, ch, cz, stype, arr_len, arr_ptr,
+                                            gz_ptr, gh_ptr)
         else:
-            return arr
+            pgm_random_polyagamma_fill2_grad(bitgen, h_ptr, z_ptr, stype, arr_len,
+                                             arr_ptr, gz_ptr, gh_ptr)
+    return arr, grad_z, grad_h
+
+
+cdef extern from "pgm_threadpool.h" nogil:
+    size_t pgm_set_num_threads(size_t n)
+    size_t pgm_get_num_threads()
+    int pgm_set_cpu_affinity(const int* cpus, size_t n)
+    size_t pgm_get_cpu_affinity(int* cpus, size_t n)
+
+
+def get_num_threads():
+    """
+    get_num_threads()
+
+    Return the number of threads used by the package's parallel code paths.
+
+    Notes
+    -----
+
+    .. versionadded:: 1.4.0
+
+    The initial value is read from the ``PGM_NUM_THREADS`` environment
+    variable and defaults to 1, in which case all work runs on the calling
+    thread.
+
+    """
+    return pgm_get_num_threads()
+
+
+def set_num_threads(num_threads=None):
+    """
+    set_num_threads(num_threads=None)
+
+    Set the number of threads used by the package's parallel code paths.
+
+    Parameters
+    ----------
+    num_threads : int or None, optional
+        The number of threads, including the calling thread. If None, one
+        thread per online CPU is used.
+
+    Returns
+    -------
+    out : int
+        The previous number of threads.
+
+    Notes
+    -----
+
+    .. versionadded:: 1.4.0
+
+    All parallel code paths share a single persistent pool of worker threads,
+    so this setting bounds the number of threads the package adds to the
+    process. Running workers are stopped and lazily restarted with the new
+    size. On platforms without POSIX threads this setting has no effect.
+
+    """
+    if num_threads is None:
+        num_threads = 0
+    else:
+        try:
+            num_threads = PyNumber_Index(num_threads)
+        except TypeError:
+            num_threads = 0
+        if num_threads < 1:
+            raise ValueError("`num_threads` must be a positive integer or None")
+    return pgm_set_num_threads(num_threads)
+
+
+cdef list get_cpu_affinity():
+    cdef np.npy_intp n = pgm_get_cpu_affinity(NULL, 0)
+    cdef np.ndarray arr = np.PyArray_EMPTY(1, &n, np.NPY_INT, 0)
+
+    pgm_get_cpu_affinity(<int*>np.PyArray_DATA(arr), n)
+    return arr.tolist()
+
+
+cdef set_cpu_affinity(object cpus):
+    cdef np.ndarray arr = np.PyArray_FROM_OTF(cpus, np.NPY_INT, np.NPY_ARRAY_IN_ARRAY)
+
+    if np.PyArray_NDIM(arr) > 1 or any(np.PyArray_Ravel(np.PyArray_FROM_O(arr < 0),
+                                                        np.NPY_CORDER)):
+        raise ValueError("`cpus` must be a sequence of non-negative CPU ids")
+    if pgm_set_cpu_affinity(<int*>np.PyArray_DATA(arr), np.PyArray_SIZE(arr)) < 0:
+        raise NotImplementedError("CPU pinning is not supported on this platform")
+
+
+class threadpool_limits:
+    """
+    threadpool_limits(limits=None, cpus=None)
+
+    Limit the size and CPU affinity of the package's worker pool.
+
+    The new settings take effect immediately and the previous ones are
+    restored when used as a context manager, or when calling
+    ``restore_original_limits``. This mirrors the interface of
+    ``threadpoolctl.threadpool_limits`` so that the pool can be scheduled
+    alongside the thread pools of other libraries (e.g. BLAS).
+
+    Parameters
+    ----------
+    limits : int or None, optional
+        The number of threads to use, including the calling thread. If None,
+        the current size is kept.
+    cpus : sequence of ints or None, optional
+        The ids of the CPUs that worker threads are pinned to. Worker ``i`` is
+        pinned to ``cpus[i % len(cpus)]`` and the calling thread is never
+        pinned. An empty sequence removes any pinning. If None, the current
+        affinity is kept. Pinning is only supported on Linux.
+
+    Notes
+    -----
+
+    .. versionadded:: 1.4.0
+
+    The initial settings are read from the ``PGM_NUM_THREADS`` and
+    ``PGM_CPU_AFFINITY`` (e.g. ``"0-3,8"``) environment variables. Work is
+    split into one contiguous block of the output per thread, so that with
+    pinning each output page is first written on the NUMA node of the thread
+    that computes it.
+
+    Examples
+    --------
+    >>> from polyagamma import polyagamma_cdf, threadpool_limits
+    >>> x = np.linspace(0.01, 5, 1000000)
+    >>> with threadpool_limits(4, cpus=[0, 1, 2, 3]):
+    ...     out = polyagamma_cdf(x, h=2, z=1)
+
+    """
+    def __init__(self, limits=None, cpus=None):
+        self._num_threads = pgm_get_num_threads()
+        self._cpus = get_cpu_affinity() if cpus is not None else None
+        try:
+            if limits is not None:
+                set_num_threads(limits)
+            if cpus is not None:
+                set_cpu_affinity(cpus)
+        except BaseException:
+            # leave the pool as it was if any of the new settings is invalid.
+            self.restore_original_limits()
+            raise
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.restore_original_limits()
+
+    def restore_original_limits(self):
+        pgm_set_num_threads(self._num_threads)
+        if self._cpus is not None:
+            set_cpu_affinity(self._cpus)
+
+
+ctypedef double (*dist_func)(double x, double h, double z) nogil
 
 
 cdef extern from "pgm_density.h" nogil:
@@ -333,12 +832,24 @@ cdef extern from "pgm_density.h" nogil:
     double pgm_polyagamma_logcdf(double x, double h, double z)
     double pgm_polyagamma_pdf(double x, double h, double z)
     double pgm_polyagamma_cdf(double x, double h, double z)
+    void pgm_polyagamma_dist_fill(dist_func f, const double* x, const double* h,
+                                  const double* z, size_t n, double* out)
 
 
-ctypedef double (*dist_func)(double x, double h, double z) nogil
+cdef inline np.ndarray as_contiguous_like(object a, np.ndarray like):
+    """Return `a` broadcast to the shape of `like` as a C-contiguous array."""
+    cdef np.ndarray out
+
+    if np.PyArray_SAMESHAPE(<np.ndarray>a, like) and np.PyArray_ISCARRAY_RO(<np.ndarray>a):
+        return a
+    out = np.PyArray_EMPTY(np.PyArray_NDIM(like), np.PyArray_DIMS(like), np.NPY_DOUBLE, 0)
+    np.PyArray_CopyInto(out, <np.ndarray>a)
+    return out
 
 
 cdef object dispatch(dist_func f, object x, object h, object z):
+    cdef np.ndarray ax, ah, az
+    cdef np.npy_intp size
     cdef double cx, ch, cz
 
     if is_a_number(x) and is_a_number(h) and is_a_number(z):
@@ -354,6 +865,20 @@ cdef object dispatch(dist_func f, object x, object h, object z):
     arr = np.PyArray_EMPTY(bcast.nd, bcast.dimensions, np.NPY_DOUBLE, 0)
     cdef double* arr_ptr = <double*>np.PyArray_DATA(arr)
 
+    # the broadcast inputs are materialized so that the worker pool can split
+    # the evaluation into contiguous blocks.
+    if pgm_get_num_threads() > 1:
+        size = np.PyArray_SIZE(arr)
+        ax = as_contiguous_like(x, arr)
+        ah = as_contiguous_like(h, arr)
+        az = as_contiguous_like(z, arr)
+        with nogil:
+            pgm_polyagamma_dist_fill(f, <double*>np.PyArray_DATA(ax),
+                                     <double*>np.PyArray_DATA(ah),
+                                     <double*>np.PyArray_DATA(az),
+                                     size, arr_ptr)
+        return arr
+
     with nogil:
         while bcast.index < bcast.size:
             cx = (<double*>np.PyArray_MultiIter_DATA(bcast, 0))[0]
@@ -0,0 +1,83 @@
+"""
+Report the per-sample latency distribution of `random_polyagamma`, with and
+without the bounded-latency mode (`max_iter`), for typical inputs and for
+inputs that make the rejection samplers draw many proposals.
+
+The samples of a row are drawn in batches of `--batch` samples per call, and
+each call is timed separately. The reported latencies are the time of a call
+divided by the batch size, so the overhead of the Python call is spread over
+the batch while the cost of slow samples still shows in the upper percentiles.
+Smaller batches expose the tail better, at the price of more call overhead.
+
+Usage: python scripts/latency_benchmark.py --batches 20000 --batch 16 --max-iter 8
+"""
+import argparse
+import time
+
+import numpy as np
+
+from polyagamma import random_polyagamma
+
+
+# (region, method, h, z)
+CASES = [
+    ("typical", None, 1, 0.),
+    ("typical", None, 2.5, 20.),
+    ("typical", None, 10, 1.),
+    ("typical", None, 100, 5.),
+    # inputs for which the first proposal of a sample is rejected most often.
+    # The hybrid sampler uses `alternate` for the first two and `saddle` for
+    # the third one.
+    ("high rejection", None, 3.9, 0.),
+    ("high rejection", None, 3.5, 1.),
+    ("high rejection", None, 7.5, 0.),
+    ("high rejection", "alternate", 20, 0.5),
+    ("high rejection", "saddle", 4, 0.),
+    ("high rejection", "devroye", 6, 3.),
+]
+
+
+def measure(h, z, method, max_iter, batches, batch, rng):
+    latencies = np.empty(batches)
+    out = np.empty(batch)
+    fallbacks = 0
+    kwargs = {'method': method, 'max_iter': max_iter, 'random_state': rng,
+              'return_fallbacks': True, 'out': out}
+    clock = time.perf_counter_ns
+
+    for i in range(batches):
+        start = clock()
+        _, count = random_polyagamma(h, z, **kwargs)
+        latencies[i] = clock() - start
+        fallbacks += count
+    return latencies / batch, fallbacks
+
+
+def benchmark(batches, batch, max_iter, seed):
+    rng = np.random.default_rng(seed)
+    samples = batches * batch
+    header = (f"{'region':<16}{'method':<11}{'h':>6}{'z':>6}{'mode':>9}"
+              f"{'p50':>9}{'p99':>9}{'p99.9':>9}{'max':>10}{'fallback rate':>15}")
+    print(f"latency per sample in microseconds over {batches} calls of "
+          f"{batch} samples per row")
+    print(header)
+    print("-" * len(header))
+
+    for region, method, h, z in CASES:
+        for mode, cap in (("exact", None), ("bounded", max_iter)):
+            lat, fallbacks = measure(h, z, method, cap, batches, batch, rng)
+            p50, p99, p999 = np.percentile(lat, [50, 99, 99.9]) / 1000
+            print(f"{region:<16}{method or 'hybrid':<11}{h:>6}{z:>6}{mode:>9}"
+                  f"{p50:>9.3f}{p99:>9.3f}{p999:>9.3f}{lat.max() / 1000:>10.3f}"
+                  f"{fallbacks / samples:>15.3%}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--seed', default=12345, type=int)
+    parser.add_argument('--batches', default=20000, type=int)
+    parser.add_argument('--batch', default=16, type=int)
+    parser.add_argument('--max-iter', default=8, type=int)
+    args = parser.parse_args()
+
+    benchmark(args.batches, args.batch, args.max_iter, args.seed)
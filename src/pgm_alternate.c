@@ -28,6 +28,11 @@ typedef struct {
     double z;
     double x;
     double t;
+    // caps on proposals and inner loops, see `pgm_bounds_t`
+    size_t max_iter;
+    size_t max_inner;
+    // number of proposals left for the current J*(h, z) variate.
+    size_t budget;
 } parameter_t;
 
 /* 
@@ -196,15 +201,29 @@ set_sampling_parameters(parameter_t* const pr, double h, bool update_params)
  *      Pólya-Gamma random variates for posterior distributions derived from
  *      logistic likelihoods.(PhD thesis). Retrieved from
  *      http://hdl.handle.net/2152/21842
+ *
+ * NOTE
+ * ----
+ * The acceptance probability of the mu > t case can be as small as
+ * exp(-0.5 * h^2 / t), so at most `pr->max_inner` proposals are drawn,
+ * counting those of the truncated Gamma sampler. If none of them is accepted,
+ * `pr->budget` is set to zero to signal that the caller should give up.
  */
 static PGM_INLINE void
 random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
 {
+    size_t left = pr->max_inner;
+
     if (pr->t < pr->h_z) {
         do {
-            pr->x = 1. / random_left_bounded_gamma(bitgen_state, 0.5,
-                                                   pr->half_h2, pr->t_inv);
-        } while (log1pf(-next_float(bitgen_state)) >= -0.5 * pr->z2 * pr->x);
+            pr->x = 1. / random_left_bounded_gamma(bitgen_state, 0.5, pr->half_h2,
+                                                   pr->t_inv, &left);
+        } while (left &&
+                 log1pf(-next_float(bitgen_state)) >= -0.5 * pr->z2 * pr->x &&
+                 --left);
+        if (!left) {
+            pr->budget = 0;
+        }
         return;
     }
     do {
@@ -214,7 +233,10 @@ random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
         if (next_double(bitgen_state) * (pr->h_z + pr->x) > pr->h_z) {
             pr->x = pr->h_z2 / pr->x;
         }
-    } while (pr->x >= pr->t);
+    } while (pr->x >= pr->t && --left);
+    if (!left) {
+        pr->budget = 0;
+    }
 }
 
 /* 
@@ -225,21 +247,35 @@ random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
  * remain less than t, we sample from a Gamma distribution left-
  * truncated at 1/t (i.e X > 1/t). Then 1/X < t is an Inverse-
  * Gamma right truncated at t. Which is what we want.
+ *
+ * Every rejected proposal uses up one unit of `pr->budget`. The sampler
+ * gives up once the budget is used up, a truncated sampler draws more than
+ * `pr->max_inner` proposals or a series needs more than `pr->max_inner`
+ * terms, which it signals by setting the budget to zero.
  */
 static PGM_INLINE double
 random_jacobi_star(bitgen_t* bitgen_state, parameter_t* const pr)
 {
+    pr->budget = pr->max_iter;
     for (;;) {
+        size_t left = pr->max_inner;
+
         if (next_float(bitgen_state) <= pr->proposal_probability) {
-            pr->x = random_left_bounded_gamma(bitgen_state, pr->h,
-                                              pr->lambda_z, pr->t);
+            pr->x = random_left_bounded_gamma(bitgen_state, pr->h, pr->lambda_z,
+                                              pr->t, &left);
         }
         else if (pr->z > 0.) {
             random_right_bounded_invgauss(bitgen_state, pr);
         }
         else {
-            pr->x = 1. / random_left_bounded_gamma(bitgen_state, 0.5,
-                                                   pr->half_h2, pr->t_inv);
+            pr->x = 1. / random_left_bounded_gamma(bitgen_state, 0.5, pr->half_h2,
+                                                   pr->t_inv, &left);
+        }
+        if (!left) {
+            pr->budget = 0;
+        }
+        if (!pr->budget) {
+            return 0.;
         }
 
         pr->logx = logf(pr->x);
@@ -258,10 +294,39 @@ random_jacobi_star(bitgen_t* bitgen_state, parameter_t* const pr)
                 if (isgreaterequal(old_s, s) && isgreater(u, s))
                     break;
             }
+            if (n >= pr->max_inner) {
+                pr->budget = 0;
+                return 0.;
+            }
+        }
+        if (!--pr->budget) {
+            return 0.;
         }
     }
 }
 
+/*
+ * Add 0.25 * J*(h, z) to the sample pointed to by `out`, or mark the sample
+ * with NaN if the sampler gives up on the variate. Returns true in the latter
+ * case.
+ */
+static PGM_INLINE bool
+add_jacobi_star(bitgen_t* bitgen_state, parameter_t* const pr, double* out)
+{
+    if (isnan(*out)) {
+        return false;
+    }
+
+    double x = random_jacobi_star(bitgen_state, pr);
+
+    if (!pr->budget) {
+        *out = NAN;
+        return true;
+    }
+    *out += 0.25 * x;
+    return false;
+}
+
 void*
 memset(void* __s, int __c, size_t __n);
 /*
@@ -273,6 +338,8 @@ memset(void* __s, int __c, size_t __n);
  *      The shape parameter of the distribution. The value must be a positive.
  *  z : double
  *      The exponential tilting parameter of the distributon.
+ *  bounds : pgm_bounds_t*
+ *      Iteration limits of the bounded-latency mode, or NULL.
  *  n : size_t
  *      The number of samples to generate.
  *  out: array of type double
@@ -293,9 +360,12 @@ memset(void* __s, int __c, size_t __n);
  */
 void
 random_polyagamma_alternate(bitgen_t* bitgen_state, double h, double z,
-                            size_t n, double* out)
+                            pgm_bounds_t* bounds, size_t n, double* out)
 {
-    parameter_t pr = {.z = 0.5 * fabs(z)};
+    parameter_t pr = {.z = 0.5 * fabs(z), .max_iter = PGM_ITER_CAP(bounds),
+                      .max_inner = PGM_INNER_CAP(bounds)};
+    const double h0 = h;
+    bool gave_up = false;
     memset(out, 0, n * sizeof(*out));
 
     if (h > pgm_maxh) {
@@ -304,20 +374,24 @@ random_polyagamma_alternate(bitgen_t* bitgen_state, double h, double z,
 
         while (h > pgm_maxh) {
             for (size_t i = 0; i < n; ++i) {
-                out[i] += 0.25 * random_jacobi_star(bitgen_state, &pr);
+                gave_up |= add_jacobi_star(bitgen_state, &pr, out + i);
             }
             h -= chunk;
         }
 
         set_sampling_parameters(&pr, h, true);
         for (size_t i = 0; i < n; ++i) {
-            out[i] += 0.25 * random_jacobi_star(bitgen_state, &pr);
+            gave_up |= add_jacobi_star(bitgen_state, &pr, out + i);
+        }
+    }
+    else {
+        set_sampling_parameters(&pr, h, false);
+        for (size_t i = n; i--; ) {
+            gave_up |= add_jacobi_star(bitgen_state, &pr, out + i);
         }
-        return;
     }
 
-    set_sampling_parameters(&pr, h, false);
-    while (n--) {
-        out[n] += 0.25 * random_jacobi_star(bitgen_state, &pr);
+    if (gave_up) {
+        bounds->fallbacks += random_polyagamma_fallback(bitgen_state, h0, z, n, out);
     }
 }
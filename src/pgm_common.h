@@ -5,6 +5,7 @@
 #define PGM_COMMON_H
 
 #include "pgm_macros.h"
+#include "../include/pgm_random.h"
 
 /* numpy c-api declarations */
 PGM_EXTERN double
@@ -122,9 +123,15 @@ pgm_lgamma(double z)
  * For a > 1 we use the algorithm described in Dagpunar (1978)
  * For a == 1, we truncate an Exponential of rate=b.
  * For a < 1, we use algorithm [A4] described in Philippe (1997)
+ *
+ * `budget` is the number of proposals the caller may still draw (see
+ * `max_inner` of `pgm_bounds_t`) and must be positive. It is decremented for every rejected
+ * proposal, and the function returns early with an unusable value once it
+ * reaches zero.
  */
 PGM_INLINE double
-random_left_bounded_gamma(bitgen_t* bitgen_state, double a, double b, double t)
+random_left_bounded_gamma(bitgen_t* bitgen_state, double a, double b, double t,
+                          size_t* budget)
 {
     double x;
 
@@ -140,7 +147,7 @@ random_left_bounded_gamma(bitgen_t* bitgen_state, double a, double b, double t)
         do {
             x = b + random_standard_exponential(bitgen_state) / c0;
             threshold = amin1 * logf(x) - x * one_minus_c0 - log_m;
-        } while (log1pf(-next_float(bitgen_state)) > threshold);
+        } while (log1pf(-next_float(bitgen_state)) > threshold && --*budget);
         return t * (x / b);
     }
     else if (a == 1.) {
@@ -151,11 +158,21 @@ random_left_bounded_gamma(bitgen_t* bitgen_state, double a, double b, double t)
         const double tb = t * b;
         do {
             x = 1. + random_standard_exponential(bitgen_state) / tb;
-        } while (log1pf(-next_float(bitgen_state)) > amin1 * logf(x));
+        } while (log1pf(-next_float(bitgen_state)) > amin1 * logf(x) && --*budget);
         return t * x;
     }
 }
 
+/*
+ * Replace the elements of `out` that are NaN by draws from a fixed-cost
+ * approximation of PG(h, z). Samplers use NaN to mark the samples they gave
+ * up on in the bounded-latency mode (see `pgm_bounds_t`). Returns the number
+ * of replaced elements.
+ */
+size_t
+random_polyagamma_fallback(bitgen_t* bitgen_state, double h, double z, size_t n,
+                           double* out);
+
 /*
  * Compute function G(p, x) (A confluent hypergeometric function ratio).
  * This function is defined in equation 14 of [1] and this implementation
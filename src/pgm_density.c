@@ -36,6 +36,7 @@
  * approximate the CDF of the Polya-Gamma distribution.
  */
 #include "pgm_macros.h"
+#include "pgm_parallel.h"
 #include "../include/pgm_density.h"
 
 #define PGM_2PI 6.283185307179586  // 2 * PI
@@ -45,6 +46,11 @@
 #define PGM_MAX_SERIES_TERMS 200
 #endif
 
+// Minimum number of evaluations handed to a single thread of the worker pool.
+#ifndef PGM_DIST_GRAIN
+#define PGM_DIST_GRAIN 64
+#endif
+
 #ifndef DBL_EPSILON
 #define DBL_EPSILON 2.22045e-16
 #endif
@@ -329,3 +335,216 @@ pgm_polyagamma_logcdf(double x, double h, double z)
 
     return c + (first + log(sum));
 }
+
+/*
+ * Coefficients of the series of PG(h, z) that only depend on h, so that they
+ * can be shared by all evaluations with the same value of h. They are computed
+ * on demand, up to the largest number of terms needed so far:
+ *
+ *  lc[n] = log(gamma(n + h) / (gamma(h) * gamma(n + 1))),
+ *  dpsi[n] = digamma(n + h) - digamma(h) = \Sigma^{n-1}_{k=0} 1 / (h + k).
+ */
+struct series_coefs {
+    double h;
+    unsigned int nterms;
+    double lc[PGM_MAX_SERIES_TERMS];
+    double dpsi[PGM_MAX_SERIES_TERMS];
+};
+
+
+static PGM_INLINE void
+series_coefs_init(struct series_coefs* coefs, double h)
+{
+    coefs->h = h;
+    coefs->nterms = 1;
+    coefs->lc[0] = 0.;
+    coefs->dpsi[0] = 0.;
+}
+
+/*
+ * Compute the implicit reparameterisation gradients of a sample x of PG(h, z),
+ * where h is the value `coefs` was initialized with.
+ *
+ * Differentiating F(x|h, z) = u with respect to a parameter t while keeping u
+ * fixed gives dx/dt = -(dF/dt) / f(x|h, z). Both partial derivatives of F are
+ * evaluated term-wise from the series used in `pgm_polyagamma_cdf`. When z > 0
+ * the n'th term is w_n * G_n(x), where G_n is the CDF of the Inverse-Gaussian
+ * distribution written as
+ *
+ *  G_n(x) = Phi(A) + exp(a * z) * Phi(B), with a = 2n + h, s = sqrt(x),
+ *  A = z * s - 0.5 * a / s and B = -z * s - 0.5 * a / s.
+ *
+ * Since exp(a * z) * phi(B) = phi(A), the derivatives of G_n simplify to
+ *
+ *  dG_n/dz = a * exp(a * z) * Phi(B),
+ *  dG_n/da = -phi(A) / s + z * exp(a * z) * Phi(B).
+ *
+ * When z = 0, G_n(x) = erfc(0.5 * a / sqrt(2x)) and its derivative is
+ * dG_n/da = -exp(-a^2 / (8x)) / sqrt(2 * pi * x), while dF/dz = 0 since F is
+ * an even function of z. The derivatives of the weights w_n follow from their
+ * logarithm (see `pgm_polyagamma_cdf`). The density is evaluated in the same
+ * loop using the series of `pgm_polyagamma_pdf`. Gradients at values of x
+ * outside the support are set to zero.
+ */
+static void
+implicit_grad(struct series_coefs* coefs, double x, double z, double* dz, double* dh)
+{
+    if (islessequal(x, 0.) || isinf(x)) {
+        *dz = *dh = 0.;
+        return;
+    }
+
+    const double h = coefs->h;
+    const double s = sqrt(x);
+    double abs_z = fabs(z);
+    double c, dc_dz, dc_dh;
+    double pdf_c = (abs_z > 0. ? h * log(cosh(0.5 * z)) - 0.5 * z * z * x : 0.) +
+                   (h - 1.) * PGM_LOG2;
+    double sum_f = 0., sum_dz = 0., sum_dh = 0.;
+    double sign = 1.;
+    struct cdf_args arg = {.s2x = sqrt(2. * x)};
+
+    if (abs_z > 0.) {
+        dc_dh = log1p(exp(-abs_z));
+        dc_dz = -h / (1. + exp(abs_z));
+    }
+    else {
+        dc_dh = PGM_LOG2;
+        dc_dz = 0.;
+    }
+    c = h * dc_dh;
+
+    for (unsigned int n = 0; n < PGM_MAX_SERIES_TERMS; n++, sign = -sign) {
+        if (n == coefs->nterms) {
+            coefs->lc[n] = coefs->lc[n - 1] + log((n - 1 + h) / n);
+            coefs->dpsi[n] = coefs->dpsi[n - 1] + 1. / (n - 1 + h);
+            coefs->nterms++;
+        }
+        double a = 2 * n + h;
+        double logw = c + coefs->lc[n] - abs_z * n;
+        double dlogw_dh = dc_dh + coefs->dpsi[n];
+        double prev_f = sum_f, prev_dz = sum_dz, prev_dh = sum_dh;
+
+        sum_f += sign * a * exp(pdf_c + coefs->lc[n] - 0.125 * a * a / x);
+        if (abs_z > 0.) {
+            double qa = abs_z * s - 0.5 * a / s;
+            double la = norm_logcdf(qa);
+            double lb = a * abs_z + norm_logcdf(-abs_z * s - 0.5 * a / s);
+            double g = exp(logw + la + log1p(exp(lb - la)));
+            double eb = exp(logw + lb);
+            double pa = exp(logw - 0.5 * qa * qa - PGM_LS2PI) / s;
+            sum_dz += sign * ((dc_dz - n) * g + a * eb);
+            sum_dh += sign * (dlogw_dh * g - pa + abs_z * eb);
+        }
+        else {
+            arg.a = a;
+            double g = exp(logw + invgamma_logcdf(&arg));
+            double pa = exp(logw - 0.125 * a * a / x) / sqrt(PGM_2PI * x);
+            sum_dh += sign * (dlogw_dh * g - pa);
+        }
+
+        if (n > 0 && PGM_ISCLOSE(sum_f, prev_f, 0., DBL_EPSILON) &&
+            PGM_ISCLOSE(sum_dz, prev_dz, 0., DBL_EPSILON) &&
+            PGM_ISCLOSE(sum_dh, prev_dh, 0., DBL_EPSILON)) {
+            break;
+        }
+    }
+
+    double f = sum_f / sqrt(PGM_2PI * x * x * x);
+    // F depends on z only through |z|, so dF/dz = 0 at z = 0.
+    *dz = abs_z > 0. ? -copysign(1., z) * sum_dz / f : 0.;
+    *dh = -sum_dh / f;
+}
+
+/*
+ * Arguments of a batched evaluation of one of the distribution functions.
+ */
+struct dist_job {
+    pgm_dist_func_t func;
+    const double* x;
+    const double* h;
+    const double* z;
+    double* out;
+};
+
+
+static void
+dist_fill_block(void* arg, size_t start, size_t end)
+{
+    struct dist_job const* job = arg;
+
+    for (size_t i = start; i < end; ++i) {
+        job->out[i] = job->func(job->x[i], job->h[i], job->z[i]);
+    }
+}
+
+
+void
+pgm_polyagamma_dist_fill(pgm_dist_func_t func, const double* x, const double* h,
+                         const double* z, size_t n, double* out)
+{
+    struct dist_job job = {.func = func, .x = x, .h = h, .z = z, .out = out};
+
+    pgm_parallel_for(n, PGM_DIST_GRAIN, dist_fill_block, &job);
+}
+
+/*
+ * Arguments of a batched evaluation of implicit gradients. `step` is 0 when
+ * h and z point to scalars and 1 when they are arrays.
+ */
+struct grad_job {
+    const double* x;
+    const double* h;
+    const double* z;
+    size_t step;
+    double* dz;
+    double* dh;
+};
+
+
+static void
+grad_fill_block(void* arg, size_t start, size_t end)
+{
+    struct grad_job const* job = arg;
+    struct series_coefs coefs;
+    double dz, dh;
+
+    if (start == end) {
+        return;
+    }
+
+    series_coefs_init(&coefs, job->h[start * job->step]);
+    for (size_t i = start; i < end; ++i) {
+        double h = job->h[i * job->step];
+        if (h != coefs.h) {
+            series_coefs_init(&coefs, h);
+        }
+        implicit_grad(&coefs, job->x[i], job->z[i * job->step], &dz, &dh);
+        if (job->dz) {
+            job->dz[i] = dz;
+        }
+        if (job->dh) {
+            job->dh[i] = dh;
+        }
+    }
+}
+
+
+void
+pgm_polyagamma_implicit_grad(const double* x, double h, double z, size_t n,
+                             double* dz, double* dh)
+{
+    struct grad_job job = {.x = x, .h = &h, .z = &z, .step = 0, .dz = dz, .dh = dh};
+
+    pgm_parallel_for(n, PGM_DIST_GRAIN, grad_fill_block, &job);
+}
+
+
+void
+pgm_polyagamma_implicit_grad2(const double* x, const double* h, const double* z,
+                              size_t n, double* dz, double* dh)
+{
+    struct grad_job job = {.x = x, .h = h, .z = z, .step = 1, .dz = dz, .dh = dh};
+
+    pgm_parallel_for(n, PGM_DIST_GRAIN, grad_fill_block, &job);
+}
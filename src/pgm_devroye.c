@@ -1,13 +1,7 @@
 /* Copyright (c) 2020-2021, Zolisa Bleki
  *
  * SPDX-License-Identifier: BSD-3-Clause */
-#include "pgm_macros.h"
-
-/* numpy random c-api forward declarations */
-PGM_EXTERN double
-random_standard_normal(bitgen_t* bitgen_state);
-PGM_EXTERN double
-random_standard_exponential(bitgen_t* bitgen_state);
+#include "pgm_common.h"
 
 // the truncation point
 #define T 0.64
@@ -22,6 +16,11 @@ typedef struct {
     double z;
     double k;
     double x;
+    // caps on proposals and inner loops, see `pgm_bounds_t`
+    size_t max_iter;
+    size_t max_inner;
+    // number of proposals left for the current J*(1, z) variate.
+    size_t budget;
 } parameter_t;
 
 /* 
@@ -102,6 +101,9 @@ set_sampling_parameters(parameter_t* const pr)
  * probability. The probability is exp(-0.5 * z2 * x) (Refer to Appendix 1 of
  * [1] for its derivation).
  *
+ * At most `pr->max_inner` proposals are drawn. If none of them is accepted,
+ * `pr->budget` is set to zero to signal that the caller should give up.
+ *
  * References
  * ----------
  *  [1] Windle, J. (2013). Forecasting high-dimensional, time-varying
@@ -114,6 +116,7 @@ static PGM_INLINE double
 random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
 {
     double x;
+    size_t left = pr->max_inner;
     // 1 / T = 1.5625
     if (pr->z < 1.5625) {
         do {
@@ -121,10 +124,15 @@ random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
             do {
                 e1 = random_standard_exponential(bitgen_state);
                 e2 = random_standard_exponential(bitgen_state);
-            } while (e1 * e1 > 3.125 * e2);  // 2 / T = 3.125
+            } while (e1 * e1 > 3.125 * e2 && --left);  // 2 / T = 3.125
             x = (1. + T * e1);
             x = T / (x * x);
-        } while (pr->z > 0. && log1pf(-next_float(bitgen_state)) >= -0.5 * pr->z2 * x);
+        } while (left && pr->z > 0. &&
+                 log1pf(-next_float(bitgen_state)) >= -0.5 * pr->z2 * x &&
+                 --left);
+        if (!left) {
+            pr->budget = 0;
+        }
         return x;
     }
     do {
@@ -137,7 +145,10 @@ random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
         if (next_double(bitgen_state) * (1. + x * pr->z) > 1.) {
             x = 1. / (x * pr->z2);
         }
-    } while (x >= T);
+    } while (x >= T && --left);
+    if (!left) {
+        pr->budget = 0;
+    }
     return x;
 }
 
@@ -156,10 +167,16 @@ random_right_bounded_invgauss(bitgen_t* bitgen_state, parameter_t* const pr)
  *  bound of the expected number of iterations needed to reject/accept is n=3.
  *  This gives opportunity to avoid the branching in the loop almost always if
  *  we perform the first iteration manually.
+ *
+ *  Every rejected proposal uses up one unit of `pr->budget`. The sampler
+ *  gives up once the budget is used up, the truncated Inverse-Gaussian
+ *  sampler gives up or a series needs more than `pr->max_inner` terms, which
+ *  it signals by setting the budget to zero.
  */
 static PGM_INLINE double
 random_jacobi_star(bitgen_t* bitgen_state, parameter_t* const pr)
 {
+    pr->budget = pr->max_iter;
     for (;;) {
         if (next_double(bitgen_state) < pr->proposal_probability) {
             pr->x = random_right_bounded_invgauss(bitgen_state, pr);
@@ -168,6 +185,9 @@ random_jacobi_star(bitgen_t* bitgen_state, parameter_t* const pr)
         else {
             pr->x = T + random_standard_exponential(bitgen_state) / pr->k;
         }
+        if (!pr->budget) {
+            return 0.;
+        }
         float s = piecewise_coef(0, pr);
         float u = next_float(bitgen_state) * s;
 
@@ -185,6 +205,13 @@ random_jacobi_star(bitgen_t* bitgen_state, parameter_t* const pr)
             else if (u > s && !signbit(sign)) {
                 break;
             }
+            else if ((size_t)i >= pr->max_inner) {
+                pr->budget = 0;
+                return 0.;
+            }
+        }
+        if (!--pr->budget) {
+            return 0.;
         }
     }
 }
@@ -202,6 +229,8 @@ memset(void* __s, int __c, size_t __n);
  *      nearest integer smaller than h.
  *  z : double
  *      The exponential tilting parameter of the distributon.
+ *  bounds : pgm_bounds_t*
+ *      Iteration limits of the bounded-latency mode, or NULL.
  *  n : size_t
  *      The number of samples to generate.
  *  out: array of type double
@@ -210,19 +239,32 @@ memset(void* __s, int __c, size_t __n);
  */
 void
 random_polyagamma_devroye(bitgen_t* bitgen_state, double h, double z,
-                          size_t n, double* out)
+                          pgm_bounds_t* bounds, size_t n, double* out)
 {
-    parameter_t pr = {.z = 0.5 * fabs(z)};
+    parameter_t pr = {.z = 0.5 * fabs(z), .max_iter = PGM_ITER_CAP(bounds),
+                      .max_inner = PGM_INNER_CAP(bounds), .budget = 1};
+    bool gave_up = false;
 
     set_sampling_parameters(&pr);
     memset(out, 0, n * sizeof(*out));
 
     for (size_t i = 0; i < n; ++i) {
         size_t hi = h;
-        while (hi--) {
+        while (hi-- && pr.budget) {
             out[i] += random_jacobi_star(bitgen_state, &pr);
         }
-        out[i] *= 0.25;
+        if (pr.budget) {
+            out[i] *= 0.25;
+        }
+        else {
+            out[i] = NAN;
+            pr.budget = 1;
+            gave_up = true;
+        }
+    }
+
+    if (gave_up) {
+        bounds->fallbacks += random_polyagamma_fallback(bitgen_state, h, z, n, out);
     }
 }
 
@@ -6,6 +6,7 @@
 #define PGM_MACROS_H
 
 #include <math.h>
+#include <stdint.h>
 #include <numpy/random/bitgen.h>
 
 #define PGM_PI       3.141592653589793238462643383279503   // pi
@@ -36,6 +37,20 @@
 
 #define PGM_MAX(x, y) (((x) > (y)) ? (x) : (y))
 
+/*
+ * Return the iteration cap stored in a (possibly NULL) pointer to a
+ * `pgm_bounds_t` struct. SIZE_MAX is used to represent "no cap".
+ */
+#define PGM_ITER_CAP(bounds) \
+    (((bounds) && (bounds)->max_iter) ? (bounds)->max_iter : SIZE_MAX)
+
+/*
+ * Return the inner loop cap stored in a (possibly NULL) pointer to a
+ * `pgm_bounds_t` struct. SIZE_MAX is used to represent "no cap".
+ */
+#define PGM_INNER_CAP(bounds) \
+    (((bounds) && (bounds)->max_inner) ? (bounds)->max_inner : SIZE_MAX)
+
 /*
  * Test if two numbers equal within the given absolute and relative tolerences
  *
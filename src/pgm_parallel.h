@@ -0,0 +1,27 @@
+/* Copyright (c) 2021, Zolisa Bleki
+ *
+ * SPDX-License-Identifier: BSD-3-Clause */
+#ifndef PGM_PARALLEL_H
+#define PGM_PARALLEL_H
+
+#include <stddef.h>
+
+/*
+ * A unit of work operating on the half-open index range [start, end).
+ */
+typedef void
+(*pgm_task_t)(void* arg, size_t start, size_t end);
+
+/*
+ * Run `func` over the range [0, n) using the shared worker pool.
+ *
+ * The range is split into at most `pgm_get_num_threads()` contiguous blocks
+ * of at least `grain` elements each. The calling thread always processes the
+ * first block. If the range is too small to split, or the pool is already
+ * busy with a job submitted by another thread, `func` runs serially on the
+ * calling thread. This function returns only once every block is done.
+ */
+void
+pgm_parallel_for(size_t n, size_t grain, pgm_task_t func, void* arg);
+
+#endif
@@ -1,6 +1,7 @@
 /* Copyright (c) 2020-2021, Zolisa Bleki
  *
  * SPDX-License-Identifier: BSD-3-Clause */
+#include "../include/pgm_density.h"
 #include "../include/pgm_random.h"
 
 #if defined(_MSC_VER)
@@ -20,13 +21,13 @@ random_standard_gamma(bitgen_t* bitgen_state, double shape);
 /* forward declarations of supported sampling methods */
 void
 random_polyagamma_devroye(bitgen_t* bitgen_state, double h, double z,
-                          size_t n, double* out);
+                          pgm_bounds_t* bounds, size_t n, double* out);
 void
 random_polyagamma_alternate(bitgen_t* bitgen_state, double h, double z,
-                            size_t n, double* out);
+                            pgm_bounds_t* bounds, size_t n, double* out);
 void
 random_polyagamma_saddle(bitgen_t* bitgen_state, double h, double z,
-                         size_t n, double* out);
+                         pgm_bounds_t* bounds, size_t n, double* out);
 
 /* libc math library forward declarations */
 double
@@ -50,8 +51,9 @@ fabs(double x);
  */
 static PGM_INLINE void
 random_polyagamma_normal_approx(bitgen_t* bitgen_state, double h, double z,
-                                size_t n, double* out)
+                                pgm_bounds_t* bounds, size_t n, double* out)
 {
+    (void)bounds;
     double x, mean, stdev;
 
     if (z == 0.) {
@@ -82,8 +84,9 @@ memset(void* s, int c, size_t n);
  */
 static PGM_INLINE void
 random_polyagamma_gamma_conv(bitgen_t* bitgen_state, double h, double z,
-                             size_t n, double* out)
+                             pgm_bounds_t* bounds, size_t n, double* out)
 {
+    (void)bounds;
     z = 0.5 * fabs(z);
     static const double pi2 = 9.869604401089358;
     double z2 = z * z;
@@ -108,25 +111,26 @@ random_polyagamma_gamma_conv(bitgen_t* bitgen_state, double h, double z,
  */
 static PGM_INLINE void
 random_polyagamma_hybrid(bitgen_t* bitgen_state, double h, double z,
-                         size_t n, double* out)
+                         pgm_bounds_t* bounds, size_t n, double* out)
 {
     if (h > 50.) {
-        random_polyagamma_normal_approx(bitgen_state, h, z, n, out);
+        random_polyagamma_normal_approx(bitgen_state, h, z, bounds, n, out);
     }
     else if (h >= 8. || (h > 4. &&  z <= 4.)) {
-        random_polyagamma_saddle(bitgen_state, h, z, n, out);
+        random_polyagamma_saddle(bitgen_state, h, z, bounds, n, out);
     }
     else if (h == 1. || (h == (size_t)h && z <= 1.)) {
-        random_polyagamma_devroye(bitgen_state, h, z, n, out);
+        random_polyagamma_devroye(bitgen_state, h, z, bounds, n, out);
     }
     else {
-       random_polyagamma_alternate(bitgen_state, h, z, n, out);
+       random_polyagamma_alternate(bitgen_state, h, z, bounds, n, out);
     }
 }
 
 
 typedef void
-(*pgm_func_t)(bitgen_t* bitgen_state, double h, double z, size_t n, double* out);
+(*pgm_func_t)(bitgen_t* bitgen_state, double h, double z, pgm_bounds_t* bounds,
+              size_t n, double* out);
 
 static const pgm_func_t sampling_method_table[] = {
     [ALTERNATE] = random_polyagamma_alternate,
@@ -142,7 +146,7 @@ pgm_random_polyagamma(bitgen_t* bitgen_state, double h, double z, sampler_t meth
 {
     double out;
 
-    sampling_method_table[method](bitgen_state, h, z, 1, &out);
+    sampling_method_table[method](bitgen_state, h, z, NULL, 1, &out);
     return out;
 }
 
@@ -151,17 +155,57 @@ void
 pgm_random_polyagamma_fill(bitgen_t* bitgen_state, double h, double z,
                            sampler_t method, size_t n, double* out)
 {
-    sampling_method_table[method](bitgen_state, h, z, n, out);
+    sampling_method_table[method](bitgen_state, h, z, NULL, n, out);
 }
 
 
 void
 pgm_random_polyagamma_fill2(bitgen_t* bitgen_state, const double* h, const double* z,
                             sampler_t method, size_t n, double* PGM_RESTRICT out)
+{
+    pgm_random_polyagamma_fill2_bounded(bitgen_state, h, z, method, NULL, n, out);
+}
+
+
+void
+pgm_random_polyagamma_fill_bounded(bitgen_t* bitgen_state, double h, double z,
+                                   sampler_t method, pgm_bounds_t* bounds,
+                                   size_t n, double* out)
+{
+    sampling_method_table[method](bitgen_state, h, z, bounds, n, out);
+}
+
+
+void
+pgm_random_polyagamma_fill2_bounded(bitgen_t* bitgen_state, const double* h,
+                                    const double* z, sampler_t method,
+                                    pgm_bounds_t* bounds, size_t n,
+                                    double* PGM_RESTRICT out)
 {
     pgm_func_t f = sampling_method_table[method];
 
     while (n--) {
-        f(bitgen_state, h[n], z[n], 1, out + n);
+        f(bitgen_state, h[n], z[n], bounds, 1, out + n);
     }
 }
+
+
+void
+pgm_random_polyagamma_fill_grad(bitgen_t* bitgen_state, double h, double z,
+                                sampler_t method, size_t n, double* out,
+                                double* dz, double* dh)
+{
+    sampling_method_table[method](bitgen_state, h, z, NULL, n, out);
+    pgm_polyagamma_implicit_grad(out, h, z, n, dz, dh);
+}
+
+
+void
+pgm_random_polyagamma_fill2_grad(bitgen_t* bitgen_state, const double* h,
+                                 const double* z, sampler_t method, size_t n,
+                                 double* PGM_RESTRICT out, double* PGM_RESTRICT dz,
+                                 double* PGM_RESTRICT dh)
+{
+    pgm_random_polyagamma_fill2(bitgen_state, h, z, method, n, out);
+    pgm_polyagamma_implicit_grad2(out, h, z, n, dz, dh);
+}
@@ -300,18 +300,31 @@ invgauss_logcdf(double x, double mu, double lambda)
  *      The shape parameter of the distribution. The value must be a positive.
  *  z : double
  *      The exponential tilting parameter of the distributon.
+ *  bounds : pgm_bounds_t*
+ *      Iteration limits of the bounded-latency mode, or NULL.
  *  n : size_t
  *      The number of samples to generate.
  *  out: array of type double
  *      The array to place the generated samples. Only the first `n` elements
  *      will be populated.
+ *
+ *  Notes
+ *  -----
+ *  Every rejected proposal uses up one unit of the budget set by `bounds`,
+ *  and the truncated samplers draw at most `bounds->max_inner` proposals.
+ *  Samples for which either cap is reached are replaced by draws from
+ *  `random_polyagamma_fallback`. The
+ *  number of Newton iterations needed to evaluate the saddle point
+ *  approximation is always capped at `PGM_MAX_ITER`.
  */
 void
 random_polyagamma_saddle(bitgen_t* bitgen_state, double h, double z,
-                         size_t n, double* out)
+                         pgm_bounds_t* bounds, size_t n, double* out)
 {
     double sqrt_rho, sqrt_rho_inv, hrho;
     float proposal_probability, p, q;
+    size_t max_iter = PGM_ITER_CAP(bounds), max_inner = PGM_INNER_CAP(bounds);
+    bool gave_up = false;
     parameter_t pr;
 
     set_sampling_parameters(&pr, h, 0.5 * fabs(z));
@@ -328,8 +341,10 @@ random_polyagamma_saddle(bitgen_t* bitgen_state, double h, double z,
     proposal_probability = p / (p + q);
 
     double mu2 = sqrt_rho_inv * sqrt_rho_inv;
-    while (n--) {
-        do {
+    for (size_t i = n; i--; ) {
+        size_t budget = max_iter;
+        for (;;) {
+            size_t left = max_inner;
             if (next_float(bitgen_state) < proposal_probability) {
                 do {
                     double y = random_standard_normal(bitgen_state);
@@ -338,13 +353,34 @@ random_polyagamma_saddle(bitgen_t* bitgen_state, double h, double z,
                     if (next_double(bitgen_state) * (1. + pr.x * sqrt_rho) > 1.) {
                         pr.x = mu2 / pr.x;
                     }
-                } while (pr.x >= pr.xc);
+                } while (pr.x >= pr.xc && --left);
             }
             else {
-                pr.x = random_left_bounded_gamma(bitgen_state, h, hrho, pr.xc);
+                pr.x = random_left_bounded_gamma(bitgen_state, h, hrho, pr.xc, &left);
+            }
+            if (!left) {
+                budget = 0;
+                break;
+            }
+            if (!isgreater(next_float(bitgen_state) * bounding_kernel(&pr),
+                           saddle_point(&pr))) {
+                break;
             }
-        } while (next_float(bitgen_state) * bounding_kernel(&pr) > saddle_point(&pr));
+            if (!--budget) {
+                break;
+            }
+        }
+
+        if (budget) {
+            out[i] = 0.25 * h * pr.x;
+        }
+        else {
+            out[i] = NAN;
+            gave_up = true;
+        }
+    }
 
-        out[n] = 0.25 * h * pr.x;
+    if (gave_up) {
+        bounds->fallbacks += random_polyagamma_fallback(bitgen_state, h, z, n, out);
     }
 }
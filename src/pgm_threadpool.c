@@ -0,0 +1,412 @@
+/* Copyright (c) 2021, Zolisa Bleki
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * NOTE
+ * ----
+ * This module implements the persistent worker pool shared by every parallel
+ * code path of the library. Having a single pool (instead of one per call
+ * site) keeps the number of threads the library adds to a process fixed and
+ * under the control of the user, which matters when it has to co-exist with
+ * other threaded libraries like BLAS.
+ *
+ * The pool runs one job at a time. A job is a range [0, n) split into
+ * contiguous blocks, where the calling thread processes block 0 and worker
+ * `i` processes block `i`. Workers sleep on a condition variable between jobs
+ * and are (re)started lazily whenever the size or the CPU affinity changes.
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // needed for pthread_attr_setaffinity_np
+#endif
+#include <stdbool.h>
+#include <stdlib.h>
+#include "pgm_parallel.h"
+#include "../include/pgm_threadpool.h"
+
+#ifndef PGM_MAX_THREADS
+#define PGM_MAX_THREADS 256
+#endif
+#ifndef PGM_MAX_CPUS
+#define PGM_MAX_CPUS 1024
+#endif
+
+#define PGM_MIN(x, y) (((x) < (y)) ? (x) : (y))
+
+/*
+ * Return the bounds of block `k` when [0, n) is split into `nblocks` blocks
+ * whose sizes differ by at most one element.
+ */
+#define block_start(k, n, nblocks) \
+    ((k) * ((n) / (nblocks)) + PGM_MIN((k), (n) % (nblocks)))
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct {
+    size_t id;
+    unsigned long generation;
+} worker_arg_t;
+
+static struct {
+    // held by the thread that owns the pool while it runs a job or resizes it.
+    pthread_mutex_t submit;
+    // guards the job description and the bookkeeping fields below.
+    pthread_mutex_t lock;
+    pthread_cond_t job_posted;
+    pthread_cond_t job_done;
+    pthread_t workers[PGM_MAX_THREADS];
+    worker_arg_t args[PGM_MAX_THREADS];
+    // number of running workers, excluding the calling thread.
+    size_t nworkers;
+    // number of threads requested, including the calling thread.
+    size_t nthreads;
+    int cpus[PGM_MAX_CPUS];
+    size_t ncpus;
+    unsigned long generation;
+    size_t remaining;
+    bool shutdown;
+    pgm_task_t func;
+    void* arg;
+    size_t n;
+    size_t nblocks;
+} pool = {
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .job_posted = PTHREAD_COND_INITIALIZER,
+    .job_done = PTHREAD_COND_INITIALIZER,
+    .nthreads = 1,
+};
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+
+static size_t
+online_cpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
+
+static size_t
+clamp_num_threads(size_t n)
+{
+    if (n == 0) {
+        n = online_cpus();
+    }
+    return PGM_MIN(n, PGM_MAX_THREADS);
+}
+
+/*
+ * Parse a CPU list of the form "0-3,8,10" into `pool.cpus`. Parsing stops at
+ * the first malformed entry.
+ */
+static void
+parse_cpu_list(const char* s)
+{
+    char* end;
+
+    pool.ncpus = 0;
+    while (*s && pool.ncpus < PGM_MAX_CPUS) {
+        long first = strtol(s, &end, 10);
+        long last = first;
+        if (end == s || first < 0) {
+            return;
+        }
+        s = end;
+        if (*s == '-') {
+            last = strtol(++s, &end, 10);
+            if (end == s || last < first) {
+                return;
+            }
+            s = end;
+        }
+        for (long cpu = first; cpu <= last && pool.ncpus < PGM_MAX_CPUS; ++cpu) {
+            pool.cpus[pool.ncpus++] = (int)cpu;
+        }
+        if (*s == ',') {
+            s++;
+        }
+        else if (*s) {
+            return;
+        }
+    }
+}
+
+/*
+ * A forked child inherits the pool's memory but none of its threads, so it
+ * has to forget about the workers of its parent.
+ */
+static void
+reset_after_fork(void)
+{
+    pthread_mutex_init(&pool.submit, NULL);
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.job_posted, NULL);
+    pthread_cond_init(&pool.job_done, NULL);
+    pool.nworkers = 0;
+    pool.remaining = 0;
+    pool.shutdown = false;
+}
+
+
+static void
+init_from_environment(void)
+{
+    const char* s = getenv("PGM_NUM_THREADS");
+
+    if (s && *s) {
+        char* end;
+        long n = strtol(s, &end, 10);
+        if (*end == '\0' && n >= 0) {
+            pool.nthreads = clamp_num_threads(n);
+        }
+    }
+
+    s = getenv("PGM_CPU_AFFINITY");
+    if (s && *s) {
+        parse_cpu_list(s);
+    }
+    pthread_atfork(NULL, NULL, reset_after_fork);
+}
+
+
+static void*
+worker_main(void* varg)
+{
+    worker_arg_t* warg = varg;
+    unsigned long seen = warg->generation;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (!pool.shutdown && pool.generation == seen) {
+            pthread_cond_wait(&pool.job_posted, &pool.lock);
+        }
+        if (pool.shutdown) {
+            break;
+        }
+        seen = pool.generation;
+        if (warg->id < pool.nblocks) {
+            size_t start = block_start(warg->id, pool.n, pool.nblocks);
+            size_t end = block_start(warg->id + 1, pool.n, pool.nblocks);
+            pgm_task_t func = pool.func;
+            void* arg = pool.arg;
+
+            pthread_mutex_unlock(&pool.lock);
+            func(arg, start, end);
+            pthread_mutex_lock(&pool.lock);
+        }
+        if (--pool.remaining == 0) {
+            pthread_cond_signal(&pool.job_done);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+/*
+ * Start workers until the pool has `pool.nthreads - 1` of them. Must be
+ * called with `pool.submit` held. If a thread cannot be created the pool
+ * simply runs with fewer workers.
+ */
+static void
+start_workers(void)
+{
+    while (pool.nworkers + 1 < pool.nthreads) {
+        size_t i = pool.nworkers;
+        pthread_attr_t attr;
+        int err;
+
+        pool.args[i].id = i + 1;
+        pool.args[i].generation = pool.generation;
+
+        pthread_attr_init(&attr);
+#if defined(__linux__)
+        if (pool.ncpus) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(pool.cpus[i % pool.ncpus], &set);
+            pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+        }
+#endif
+        err = pthread_create(&pool.workers[i], &attr, worker_main, &pool.args[i]);
+        pthread_attr_destroy(&attr);
+        if (err && pool.ncpus) {
+            // an invalid CPU id makes thread creation fail; run unpinned.
+            err = pthread_create(&pool.workers[i], NULL, worker_main, &pool.args[i]);
+        }
+        if (err) {
+            return;
+        }
+        pool.nworkers++;
+    }
+}
+
+/*
+ * Stop and join all running workers. Must be called with `pool.submit` held.
+ */
+static void
+stop_workers(void)
+{
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = true;
+    pthread_cond_broadcast(&pool.job_posted);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (size_t i = 0; i < pool.nworkers; ++i) {
+        pthread_join(pool.workers[i], NULL);
+    }
+
+    pool.nworkers = 0;
+    pool.shutdown = false;
+}
+
+
+void
+pgm_parallel_for(size_t n, size_t grain, pgm_task_t func, void* arg)
+{
+    size_t nblocks;
+
+    pthread_once(&pool_once, init_from_environment);
+
+    if (n < 2 * grain || pthread_mutex_trylock(&pool.submit)) {
+        func(arg, 0, n);
+        return;
+    }
+
+    start_workers();
+    nblocks = PGM_MIN(pool.nworkers + 1, grain ? n / grain : n);
+    if (nblocks < 2) {
+        pthread_mutex_unlock(&pool.submit);
+        func(arg, 0, n);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.func = func;
+    pool.arg = arg;
+    pool.n = n;
+    pool.nblocks = nblocks;
+    pool.remaining = pool.nworkers;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.job_posted);
+    pthread_mutex_unlock(&pool.lock);
+
+    func(arg, 0, block_start(1, n, nblocks));
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.remaining) {
+        pthread_cond_wait(&pool.job_done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.submit);
+}
+
+
+size_t
+pgm_set_num_threads(size_t n)
+{
+    size_t old;
+
+    pthread_once(&pool_once, init_from_environment);
+    pthread_mutex_lock(&pool.submit);
+    old = pool.nthreads;
+    pool.nthreads = clamp_num_threads(n);
+    if (pool.nworkers + 1 > pool.nthreads) {
+        stop_workers();
+    }
+    pthread_mutex_unlock(&pool.submit);
+    return old;
+}
+
+
+size_t
+pgm_get_num_threads(void)
+{
+    size_t n;
+
+    pthread_once(&pool_once, init_from_environment);
+    pthread_mutex_lock(&pool.submit);
+    n = pool.nthreads;
+    pthread_mutex_unlock(&pool.submit);
+    return n;
+}
+
+
+int
+pgm_set_cpu_affinity(const int* cpus, size_t n)
+{
+#if defined(__linux__)
+    pthread_once(&pool_once, init_from_environment);
+    pthread_mutex_lock(&pool.submit);
+    pool.ncpus = PGM_MIN(n, PGM_MAX_CPUS);
+    for (size_t i = 0; i < pool.ncpus; ++i) {
+        pool.cpus[i] = cpus[i];
+    }
+    stop_workers();
+    pthread_mutex_unlock(&pool.submit);
+    return 0;
+#else
+    return n ? -1 : 0;
+#endif
+}
+
+
+size_t
+pgm_get_cpu_affinity(int* cpus, size_t n)
+{
+    size_t ncpus;
+
+    pthread_once(&pool_once, init_from_environment);
+    pthread_mutex_lock(&pool.submit);
+    ncpus = pool.ncpus;
+    for (size_t i = 0; i < PGM_MIN(n, ncpus); ++i) {
+        cpus[i] = pool.cpus[i];
+    }
+    pthread_mutex_unlock(&pool.submit);
+    return ncpus;
+}
+
+#else  /* no POSIX threads: run everything on the calling thread */
+
+void
+pgm_parallel_for(size_t n, size_t grain, pgm_task_t func, void* arg)
+{
+    (void)grain;
+    func(arg, 0, n);
+}
+
+
+size_t
+pgm_set_num_threads(size_t n)
+{
+    (void)n;
+    return 1;
+}
+
+
+size_t
+pgm_get_num_threads(void)
+{
+    return 1;
+}
+
+
+int
+pgm_set_cpu_affinity(const int* cpus, size_t n)
+{
+    (void)cpus;
+    return n ? -1 : 0;
+}
+
+
+size_t
+pgm_get_cpu_affinity(int* cpus, size_t n)
+{
+    (void)cpus;
+    (void)n;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,243 @@
+/* Copyright (c) 2021, Zolisa Bleki
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * NOTE
+ * ----
+ * This module implements a sampler of PG(h, z) for small |z| that does not
+ * need any z-dependent setup. It is based on the relation
+ *
+ *  f(x|h, z) = cosh(z / 2)^h * exp(-0.5 * z^2 * x) * f(x|h, 0),
+ *
+ * (see page 5 of Polson et al. (2013)) which means that PG(h, z) can be
+ * sampled by drawing x ~ PG(h, 0) and accepting it with probability
+ * exp(-0.5 * z^2 * x). The acceptance rate is cosh(z / 2)^(-h), which is close
+ * to 1 for small |z|.
+ *
+ * Samples from PG(h, 0) are generated by inverting a table of its CDF that is
+ * built once per value of h using `pgm_polyagamma_cdf`. The CDF is tabulated
+ * on a logarithmic grid and inverted using linear interpolation, with a guide
+ * table (Chen & Asau, 1974) that finds the right grid interval in O(1)
+ * expected time. The samples are thus approximate, with an error controlled
+ * by the size of the table. Values of |z| for which the acceptance rate would
+ * drop below `PGM_TILT_MIN_ACCEPT` are sampled using a regular method, and so
+ * is every value of z when the series of the CDF is not accurate enough to
+ * build the table (i.e. for large h).
+ */
+#include <stdlib.h>
+#include "pgm_common.h"
+#include "pgm_parallel.h"
+#include "../include/pgm_density.h"
+
+// number of grid points of a table, including the point x = 0.
+#ifndef PGM_TABLE_SIZE
+#define PGM_TABLE_SIZE 1024
+#endif
+// probability mass left outside the tabulated range on either side.
+#ifndef PGM_TABLE_TAIL
+#define PGM_TABLE_TAIL 1e-12
+#endif
+// largest error of the tabulated cdf values that is tolerated.
+#ifndef PGM_TABLE_TOL
+#define PGM_TABLE_TOL 1e-6
+#endif
+// smallest acceptance rate for which the tilting sampler is used.
+#ifndef PGM_TILT_MIN_ACCEPT
+#define PGM_TILT_MIN_ACCEPT 0.5
+#endif
+// minimum number of CDF evaluations handed to a thread of the worker pool.
+#define PGM_TABLE_GRAIN 64
+
+#define PGM_PI2_2 4.934802200544679309417245499938075  // pi^2 / 2
+
+struct pgm_table {
+    double h;
+    // largest value of |z| sampled by tilting, or -1 if the table is unusable.
+    double zmax;
+    double* x;
+    double* cdf;
+    // guide[j] is the smallest index k >= 1 such that cdf[k] >= j / size.
+    size_t* guide;
+    size_t size;
+};
+
+/*
+ * Fill the cdf values of the grid points in [start, end).
+ */
+static void
+tabulate_cdf(void* arg, size_t start, size_t end)
+{
+    pgm_table_t* table = arg;
+
+    for (size_t k = start; k < end; ++k) {
+        table->cdf[k] = pgm_polyagamma_cdf(table->x[k], table->h, 0.);
+    }
+}
+
+
+pgm_table_t*
+pgm_polyagamma_table_new(double h)
+{
+    const size_t size = PGM_TABLE_SIZE;
+    pgm_table_t* table = malloc(sizeof(*table) + size * (2 * sizeof(double) +
+                                                         sizeof(size_t)));
+    double lo, hi, step;
+
+    if (!table) {
+        return NULL;
+    }
+
+    table->h = h;
+    table->size = size;
+    table->x = (double*)(table + 1);
+    table->cdf = table->x + size;
+    table->guide = (size_t*)(table->cdf + size);
+    // cosh(z / 2)^(-h) >= PGM_TILT_MIN_ACCEPT
+    table->zmax = 2. * acosh(exp(-log(PGM_TILT_MIN_ACCEPT) / h));
+
+    // find the range outside of which the distribution has negligible mass,
+    // starting from the mean of PG(h, 0).
+    for (lo = 0.25 * h; pgm_polyagamma_cdf(lo, h, 0.) > PGM_TABLE_TAIL; lo *= 0.5);
+    for (hi = 0.25 * h; 1. - pgm_polyagamma_cdf(hi, h, 0.) > PGM_TABLE_TAIL; hi *= 2.);
+
+    table->x[0] = 0.;
+    step = log(hi / lo) / (size - 2);
+    for (size_t k = 1; k < size; ++k) {
+        table->x[k] = lo * exp(step * (k - 1));
+    }
+
+    pgm_parallel_for(size, PGM_TABLE_GRAIN, tabulate_cdf, table);
+    // enforce monotonicity in case the series approximation of the cdf is not,
+    // but give up on the table if the series has lost its precision, which
+    // happens in the right tail when h is large.
+    for (size_t k = 1; k < size; ++k) {
+        if (!(table->cdf[k] < 1. + PGM_TABLE_TOL &&
+              table->cdf[k] > table->cdf[k - 1] - PGM_TABLE_TOL)) {
+            table->zmax = -1.;
+        }
+        if (table->cdf[k] < table->cdf[k - 1]) {
+            table->cdf[k] = table->cdf[k - 1];
+        }
+        else if (table->cdf[k] > 1.) {
+            table->cdf[k] = 1.;
+        }
+    }
+
+    for (size_t j = 0, k = 1; j < size; ++j) {
+        while (k < size - 1 && table->cdf[k] * size < j) {
+            k++;
+        }
+        table->guide[j] = k;
+    }
+
+    return table;
+}
+
+
+void
+pgm_polyagamma_table_free(pgm_table_t* table)
+{
+    free(table);
+}
+
+
+double
+pgm_polyagamma_table_zmax(const pgm_table_t* table)
+{
+    return table->zmax;
+}
+
+/*
+ * Sample from PG(h, 0) by inverting the tabulated CDF.
+ *
+ * Values of u beyond the last tabulated CDF value are mapped to the right
+ * tail of the distribution, which decays like exp(-0.5 * pi^2 * x).
+ */
+static PGM_INLINE double
+random_table_inverse_cdf(bitgen_t* bitgen_state, const pgm_table_t* table)
+{
+    const double* x = table->x;
+    const double* cdf = table->cdf;
+    double u = next_double(bitgen_state);
+
+    if (u >= cdf[table->size - 1]) {
+        return x[table->size - 1] + random_standard_exponential(bitgen_state) / PGM_PI2_2;
+    }
+
+    size_t k = table->guide[(size_t)(u * table->size)];
+    while (cdf[k] <= u) {
+        k++;
+    }
+    return x[k - 1] + (x[k] - x[k - 1]) * (u - cdf[k - 1]) / (cdf[k] - cdf[k - 1]);
+}
+
+/*
+ * Sample from PG(h, z) by exponentially tilting samples of PG(h, 0).
+ *
+ * NaN is returned if all `max_iter` proposals are rejected, so that the
+ * sample can be replaced using `random_polyagamma_fallback`.
+ */
+static PGM_INLINE double
+random_tilted(bitgen_t* bitgen_state, const pgm_table_t* table, double half_z2,
+              size_t max_iter)
+{
+    double x;
+
+    do {
+        x = random_table_inverse_cdf(bitgen_state, table);
+    } while (half_z2 > 0. && log1pf(-next_float(bitgen_state)) >= -half_z2 * x &&
+             --max_iter);
+
+    return max_iter ? x : NAN;
+}
+
+
+void
+pgm_random_polyagamma_tilted_fill(bitgen_t* bitgen_state, const pgm_table_t* table,
+                                  double z, sampler_t method, pgm_bounds_t* bounds,
+                                  size_t n, double* out)
+{
+    size_t max_iter = PGM_ITER_CAP(bounds);
+    double half_z2 = 0.5 * z * z;
+    bool gave_up = false;
+
+    if (!(fabs(z) <= table->zmax)) {
+        pgm_random_polyagamma_fill_bounded(bitgen_state, table->h, z, method,
+                                           bounds, n, out);
+        return;
+    }
+
+    for (size_t i = n; i--; ) {
+        out[i] = random_tilted(bitgen_state, table, half_z2, max_iter);
+        gave_up |= isnan(out[i]);
+    }
+
+    if (gave_up) {
+        bounds->fallbacks += random_polyagamma_fallback(bitgen_state, table->h, z,
+                                                        n, out);
+    }
+}
+
+
+void
+pgm_random_polyagamma_tilted_fill2(bitgen_t* bitgen_state, const pgm_table_t* table,
+                                   const double* z, sampler_t method,
+                                   pgm_bounds_t* bounds, size_t n,
+                                   double* PGM_RESTRICT out)
+{
+    size_t max_iter = PGM_ITER_CAP(bounds);
+
+    while (n--) {
+        if (!(fabs(z[n]) <= table->zmax)) {
+            pgm_random_polyagamma_fill_bounded(bitgen_state, table->h, z[n], method,
+                                               bounds, 1, out + n);
+        }
+        else {
+            out[n] = random_tilted(bitgen_state, table, 0.5 * z[n] * z[n], max_iter);
+            if (isnan(out[n])) {
+                bounds->fallbacks += random_polyagamma_fallback(bitgen_state, table->h,
+                                                                z[n], 1, out + n);
+            }
+        }
+    }
+}
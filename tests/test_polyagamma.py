@@ -8,6 +8,10 @@ from polyagamma import (
     random_polyagamma,
     polyagamma_pdf,
     polyagamma_cdf,
+    random_polyagamma_grad,
+    get_num_threads,
+    set_num_threads,
+    threadpool_limits,
 )
 
 
@@ -111,6 +115,7 @@ def test_polyagamma():
     rng_polyagamma(method="devroye")
     rng_polyagamma(method="alternate")
     rng_polyagamma(method="saddle")
+    rng_polyagamma(method="tilted")
     # test if sampling works for sequence input when devroye and alternate
     # methods are specified. See Issue #32
     h = (1, 2, 3)
@@ -146,7 +151,7 @@ def test_polyagamma():
     assert not np.allclose(expected, random_polyagamma(size=5))
 
 # "devroye" is not included because it does not play well with non-integer h
-@pytest.mark.parametrize("method", ("alternate", "saddle", "gamma"))
+@pytest.mark.parametrize("method", ("alternate", "saddle", "gamma", "tilted"))
 @pytest.mark.parametrize("h", (0.5, 1, 4, 7, 15, 25))
 @pytest.mark.parametrize("z", (0, 1, -4, 7, -15, 25))
 def test_polyagamma_pdf_cdf(method, h, z):
@@ -189,6 +194,85 @@ def test_polyagamma_pdf_cdf(method, h, z):
     assert np.allclose(lc, cdf)
 
 
+def test_tilted_sampling():
+    rng = np.random.default_rng(2)
+    # the table is built for a fixed `h`, so it cannot be an array.
+    with pytest.raises(ValueError, match="requires a scalar `h`"):
+        random_polyagamma([1, 2], 0.5, method="tilted")
+    with pytest.raises(ValueError, match="`h` must be positive"):
+        random_polyagamma(-1, 0.5, method="tilted")
+
+    # mean of PG(h, z) is h / (2z) * tanh(z / 2), and h / 4 when z = 0.
+    z = np.array([0., 0.2, -0.5, 1.])
+    x = random_polyagamma(3, z, size=(50000, 4), method="tilted", random_state=rng)
+    expected = [3 / 4] + [3 / (2 * i) * np.tanh(i / 2) for i in z[1:]]
+    assert np.allclose(x.mean(axis=0), expected, rtol=1e-2)
+
+    out = np.empty(4)
+    assert random_polyagamma(3, z, out=out, method="tilted") is None
+    assert np.all(out > 0)
+    with pytest.raises(ValueError, match="same total size"):
+        random_polyagamma(3, z, out=np.empty(3), method="tilted")
+    assert random_polyagamma(3, z.reshape(2, 2), method="tilted").shape == (2, 2)
+    _, fallbacks = random_polyagamma(3, 0.5, size=100, method="tilted", max_iter=1,
+                                     return_fallbacks=True, random_state=rng)
+    assert 0 < fallbacks <= 100
+    # samples that reach the cap are replaced by draws from the approximation.
+    x, fallbacks = random_polyagamma(3, z, size=(50000, 4), method="tilted", max_iter=1,
+                                     return_fallbacks=True, random_state=rng)
+    assert 0 < fallbacks <= x.size
+    assert np.allclose(x.mean(axis=0), expected, rtol=1e-2)
+
+    # the table is not accurate for large `h`, so all values fall back to the
+    # hybrid sampler.
+    x = random_polyagamma(200, 0.1, size=10000, method="tilted", random_state=rng)
+    assert np.isclose(x.mean(), 100 / 0.1 * np.tanh(0.05), rtol=1e-2)
+
+
+@pytest.mark.parametrize("h", (0.5, 1, 4, 15))
+@pytest.mark.parametrize("z", (0, 0.7, -2, 10))
+def test_random_polyagamma_grad(h, z):
+    rng = np.random.default_rng(3)
+    x, grad_z, grad_h = random_polyagamma_grad(h, z, size=100, random_state=rng)
+    # the gradients are -(dF/dt) / f, so compare with finite differences.
+    eps = 1e-4
+    d = polyagamma_pdf(x, h=h, z=z)
+    fd_z = (polyagamma_cdf(x, h=h, z=z + eps) - polyagamma_cdf(x, h=h, z=z - eps)) / (2 * eps)
+    fd_h = (polyagamma_cdf(x, h=h + eps, z=z) - polyagamma_cdf(x, h=h - eps, z=z)) / (2 * eps)
+    assert np.allclose(grad_z, -fd_z / d, rtol=1e-3, atol=1e-6)
+    assert np.allclose(grad_h, -fd_h / d, rtol=1e-3, atol=1e-6)
+
+    # pathwise gradients of E[x] = h / (2z) * tanh(z / 2) must be unbiased.
+    _, grad_z, grad_h = random_polyagamma_grad(h, z, size=50000, random_state=rng)
+    if z == 0:
+        assert np.all(grad_z == 0)
+        assert np.isclose(grad_h.mean(), 0.25, rtol=1e-2)
+    else:
+        dmean_dz = h * (z / np.cosh(z / 2) ** 2 - 2 * np.tanh(z / 2)) / (4 * z * z)
+        assert np.isclose(grad_z.mean(), dmean_dz, rtol=2e-2)
+        assert np.isclose(grad_h.mean(), np.tanh(z / 2) / (2 * z), rtol=1e-2)
+
+
+def test_random_polyagamma_grad_inputs():
+    x, grad_z, grad_h = random_polyagamma_grad(random_state=1)
+    assert all(isinstance(i, float) for i in (x, grad_z, grad_h))
+    out = random_polyagamma_grad([1, 2], [[0.], [1.]], random_state=1)
+    assert all(i.shape == (2, 2) for i in out)
+    out = random_polyagamma_grad(2, [0.5, 1.], size=(3, 2), method="saddle")
+    assert all(i.shape == (3, 2) for i in out)
+    # array inputs give the same samples and gradients as scalar ones.
+    expected = random_polyagamma_grad(3, 1.5, size=10, random_state=7)
+    out = random_polyagamma_grad(np.full(10, 3.), np.full(10, 1.5), random_state=7)
+    assert all(np.allclose(i, j) for i, j in zip(out, expected))
+
+    with pytest.raises(ValueError, match="`h` must be positive"):
+        random_polyagamma_grad(-1)
+    with pytest.raises(ValueError, match="values of `h` must be positive"):
+        random_polyagamma_grad([1, -1])
+    with pytest.raises(ValueError, match="does not support gradients"):
+        random_polyagamma_grad(method="tilted")
+
+
 def test_log_extreme_value_behaviour():
     # test success of directly computing logcdf/logpdf instead of using log(*)
     with pytest.warns(RuntimeWarning, match="divide by zero encountered in log"):
@@ -202,3 +286,114 @@ def test_log_extreme_value_behaviour():
     assert np.isclose(polyagamma_pdf(1e-3, h=10, z=3, return_log=True), -12473.46649418656)
     assert np.isclose(polyagamma_cdf(1e-16, return_log=True), -1250000000000017.2)
     assert np.isclose(polyagamma_pdf(1e-16, return_log=True), -1249999999999945.8)
+
+
+def test_bounded_sampling():
+    # an unreachable cap must produce the exact same samples as no cap.
+    for method in ("devroye", "alternate", "saddle", None):
+        expected = random_polyagamma(3, 2, size=500, method=method, random_state=5)
+        out, fallbacks = random_polyagamma(3, 2, size=500, method=method,
+                                           max_iter=10**9, return_fallbacks=True,
+                                           random_state=5)
+        assert fallbacks == 0
+        assert np.array_equal(out, expected)
+        out = random_polyagamma(3, 2, size=500, method=method, max_iter=np.int64(10**9),
+                                random_state=5)
+        assert np.array_equal(out, expected)
+        assert np.array_equal(
+            random_polyagamma(3, 2, size=500, method=method, max_iter=None, random_state=5),
+            expected,
+        )
+
+    # with a cap of 1 many samples are replaced by the approximation, which
+    # must still follow the target distribution closely.
+    for h, z, method in ((1, 0, "devroye"), (4, 2, "devroye"), (10, 1, "saddle"),
+                         (3, 2, "alternate"), (0.5, 3, "alternate")):
+        out, fallbacks = random_polyagamma(h, z, size=2000, method=method, max_iter=1,
+                                           return_fallbacks=True, random_state=1)
+        assert 0 <= fallbacks <= 2000 and np.all(out > 0)
+        if method != "devroye":
+            assert fallbacks > 0
+        # Kolmogorov-Smirnov distance between the sample and the distribution.
+        out.sort()
+        cdf = polyagamma_cdf(out, h=h, z=z)
+        ks = np.max(np.maximum(np.arange(1, 2001) / 2000 - cdf, cdf - np.arange(2000) / 2000))
+        assert ks < 0.04
+    # fixed-cost methods never fall back.
+    _, fallbacks = random_polyagamma(1, 1, size=100, method="gamma", max_iter=1,
+                                     return_fallbacks=True, random_state=1)
+    assert fallbacks == 0
+    _, fallbacks = random_polyagamma(100, 1, size=100, max_iter=1,
+                                     return_fallbacks=True, random_state=1)
+    assert fallbacks == 0
+
+    # fallbacks are counted for every input type.
+    sample, fallbacks = random_polyagamma(max_iter=1, return_fallbacks=True,
+                                          random_state=3)
+    assert sample > 0 and fallbacks <= 1
+    out = np.zeros(50)
+    _, fallbacks = random_polyagamma(10, out=out, max_iter=1, return_fallbacks=True,
+                                     random_state=3)
+    assert 0 < fallbacks <= 50 and np.all(out > 0)
+    out, fallbacks = random_polyagamma(np.full(30, 10), np.tile([0, 1, 2], 10),
+                                       max_iter=1, return_fallbacks=True,
+                                       random_state=3)
+    assert out.shape == (30,) and 0 < fallbacks <= 30
+    out, fallbacks = random_polyagamma([[10], [10]], np.arange(30), max_iter=1,
+                                       return_fallbacks=True, random_state=3)
+    assert out.shape == (2, 30) and 0 < fallbacks <= 60
+    out, fallbacks = random_polyagamma(10, [0, 1], size=(40, 2), max_iter=1,
+                                       return_fallbacks=True, random_state=3)
+    assert out.shape == (40, 2) and 0 < fallbacks <= 80
+
+    with pytest.raises(ValueError, match="`max_iter` must be a positive integer"):
+        random_polyagamma(max_iter=0)
+    with pytest.raises(ValueError, match="`max_iter` must be a positive integer"):
+        random_polyagamma(max_iter=2.5)
+
+
+def test_threadpool():
+    x = np.linspace(0.01, 5, 1000)
+    h = [[1.], [2.5], [10.]]
+    z = [[[0.]], [[-1.5]]]
+    original = get_num_threads()
+    with threadpool_limits(1):
+        expected = [f(x, h, z, return_log=b) for f in (polyagamma_pdf, polyagamma_cdf)
+                    for b in (False, True)]
+
+    # results of the parallel path must be identical to the serial one.
+    with threadpool_limits(4) as limits:
+        assert get_num_threads() == 4
+        out = [f(x, h, z, return_log=b) for f in (polyagamma_pdf, polyagamma_cdf)
+               for b in (False, True)]
+        assert all(np.array_equal(a, b) for a, b in zip(out, expected))
+        # small inputs and scalars are evaluated serially.
+        assert polyagamma_pdf(0.2) == 2.339176537265802
+        assert np.allclose(polyagamma_cdf(0.75, h=[4, 3, 1]),
+                           [0.30130807, 0.57523169, 0.96855568])
+    assert get_num_threads() == original
+
+    limits = threadpool_limits(3)
+    assert get_num_threads() == 3
+    limits.restore_original_limits()
+    assert get_num_threads() == original
+
+    assert set_num_threads(2) == original
+    assert set_num_threads(original) == 2
+    assert set_num_threads(None) == original
+    assert get_num_threads() >= 1
+    # any integer type is accepted.
+    set_num_threads(np.int64(2))
+    assert get_num_threads() == 2
+    with threadpool_limits(np.uint8(3)):
+        assert get_num_threads() == 3
+    set_num_threads(original)
+
+    with pytest.raises(ValueError, match="`num_threads` must be a positive integer"):
+        set_num_threads(0)
+    with pytest.raises(ValueError, match="`num_threads` must be a positive integer"):
+        threadpool_limits(2.5)
+    with pytest.raises(ValueError, match="`cpus` must be a sequence of non-negative"):
+        threadpool_limits(3, cpus=[0, -1])
+    # a failed call must not change the settings of the pool.
+    assert get_num_threads() == original